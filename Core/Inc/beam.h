@@ -0,0 +1,79 @@
+/*
+ * beam.h
+ *
+ *  - 도어 존 빔 센서(포토 인터럽터 1개) 모듈
+ *  - 문 사이에 사람/물건이 있으면 빔이 끊긴다(BLOCKED)
+ *  - photo.c와 같은 방식: EXTI로 변화 감지 + 디바운스 + 백업 폴링
+ *  - 시뮬레이션 입력으로 실제 센서 없이도 동작 확인 가능 (UART BEAM SIM, BEAM_SIM 빌드만)
+ */
+
+#ifndef INC_BEAM_H_
+#define INC_BEAM_H_
+
+
+#include "stm32f4xx_hal.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* ==============================
+ *        시뮬레이션 입력
+ * ==============================
+ * 벤치 확인용이라 BEAM_SIM이 정의된 빌드에만 들어간다 (Debug 구성은 기본으로 켬).
+ * 양산(Release) 빌드의 판독 경로에는 실제 핀 값만 쓰인다.
+ *
+ * BEAM_SIM_OFF     : 실제 핀 값 사용
+ * BEAM_SIM_CLEAR   : 항상 빔 통과(사람 없음)로 처리
+ * BEAM_SIM_BLOCKED : 항상 빔 끊김(사람 있음)으로 처리
+ */
+#if defined(DEBUG) && !defined(BEAM_SIM)
+#define BEAM_SIM
+#endif
+
+#ifdef BEAM_SIM
+typedef enum
+{
+  BEAM_SIM_OFF = 0,
+  BEAM_SIM_CLEAR,
+  BEAM_SIM_BLOCKED
+} beam_sim_t;
+#endif
+
+
+void Beam_Init(void);
+
+/**
+ * @brief EXTI 콜백에서 호출 (빔 핀이 아니면 무시)
+ */
+void Beam_OnExti(uint16_t GPIO_Pin);
+
+/**
+ * @brief  주기적으로 호출하는 Task
+ * @retval 1: 값이 바뀜, 0: 변화 없음
+ */
+uint8_t Beam_Task(void);
+
+/**
+ * @brief  문 사이에 사람/물건이 있는지 (디바운스 후 값)
+ *
+ * 센서가 꺼져 있으면(Beam_SetEnabled(false)) 항상 false.
+ */
+bool Beam_IsBlocked(void);
+
+/**
+ * @brief  빔 센서 사용 여부 (설치되어 있으면 true)
+ *
+ * 엘리베이터는 센서가 켜져 있을 때만 짧은 대기 시간을 쓴다.
+ * 기본은 꺼짐(BEAM_ENABLE_DEFAULT): 센서 없는 보드는 핀이 늘 '통과'로 읽히기 때문.
+ */
+void Beam_SetEnabled(bool en);
+bool Beam_IsEnabled(void);
+
+#ifdef BEAM_SIM
+/* 시뮬레이션 입력 (UART ISR에서도 호출 가능, 다음 Beam_Task에서 반영) */
+void Beam_SetSim(beam_sim_t sim);
+beam_sim_t Beam_GetSim(void);
+#endif
+
+
+#endif /* INC_BEAM_H_ */
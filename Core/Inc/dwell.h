@@ -0,0 +1,102 @@
+/*
+ * dwell.h
+ *
+ *  - 문 열림 대기(dwell) 시간 결정 모듈 (elevator.c에서 분리)
+ *  - 현재 시각(ms), 빔 센서 상태, 카 호출 순번을 인자로 받는 순수 로직 (HAL 의존 없음)
+ *    -> 펌웨어는 HAL_GetTick()/Beam_*() 값을 넘기고, 호스트 테스트는 가짜 시계/센서를 넘긴다
+ *  - 모든 함수는 main 컨텍스트에서 호출
+ */
+
+#ifndef INC_DWELL_H_
+#define INC_DWELL_H_
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* 문 열림 대기(dwell) 시간
+ * - 기본: 홀 호출을 받은 정지는 DWELL_HALL_MS, 카 호출만 있던 정지는 DWELL_CAR_MS
+ * - 열린 뒤 DWELL_WINDOW_MS 안에 카 호출이 없으면 *_IDLE_MS로 단축 (타는 사람 없음)
+ * - 카 호출/같은 층 호출/OPEN 버튼이 들어올 때마다 그 시점 + DWELL_EXTEND_MS로 연장
+ *   (문 열린 뒤 DWELL_MAX_MS까지)
+ * - CLOSE 버튼은 문이 열리는 중/열려 있을 때만 즉시 닫기
+ *
+ * 도어 존 빔 센서가 있으면(Beam_IsEnabled) 기본 대기를 DWELL_BEAM_*_MS로 줄이고
+ * - 빔이 끊겨 있는 동안은 닫지 않음, 빔이 풀리면 그때부터 DWELL_BEAM_CLEAR_MS 뒤 닫기
+ * - 닫히는 중 빔이 끊기면 그 위치에서 바로 되열기
+ * - 빔이 끊겨 있으면 CLOSE 버튼 무시
+ */
+#define DWELL_HALL_MS         6000
+#define DWELL_CAR_MS          4000
+#define DWELL_WINDOW_MS       1500
+#define DWELL_HALL_IDLE_MS    3500
+#define DWELL_CAR_IDLE_MS     2000
+#define DWELL_EXTEND_MS       3000
+#define DWELL_MAX_MS          15000
+#define DWELL_BEAM_HALL_MS    3000
+#define DWELL_BEAM_CAR_MS     2000
+#define DWELL_BEAM_CLEAR_MS   1000
+
+
+/* 통계: 대기가 끝날 때마다(Dwell_End) 누적 */
+typedef struct
+{
+  uint32_t count;       // 대기 횟수
+  uint32_t totalMs;     // 누적 대기 시간(평균 = totalMs / count)
+  uint32_t minMs;
+  uint32_t maxMs;
+  uint32_t hallStops;   // 홀 호출을 처리한 정지
+  uint32_t shortened;   // 카 호출이 없어 단축
+  uint32_t extended;    // 카 호출/같은 층 호출/OPEN 버튼으로 연장
+  uint32_t closeBtn;    // CLOSE 버튼으로 닫음
+  uint32_t beamCross;   // 대기 중 빔이 끊겼다 풀린 횟수(통과 인원 추정)
+  uint32_t beamReopen;  // 닫히는 중 빔 끊김으로 되열기
+} dwell_stats_t;
+
+
+/* 진행 상태와 통계 초기화 */
+void Dwell_Init(void);
+
+/**
+ * @brief  문이 다 열린 시점에 호출: 대기 시간 기준을 정한다
+ * @param  now         : 현재 시각(ms)
+ * @param  hall        : 이번 정지에서 홀 호출을 처리했는지 (대기 중에는 바뀌지 않음)
+ * @param  beamEnabled : 빔 센서 사용 여부 (짧은 DWELL_BEAM_*_MS 기준)
+ * @param  callSeq     : 현재 카 호출 순번 (이후 증가분을 탑승 활동으로 센다)
+ */
+void Dwell_Begin(uint32_t now, bool hall, bool beamEnabled, uint8_t callSeq);
+
+/* 탑승 활동(같은 층 호출, OPEN 버튼): 지금부터 DWELL_EXTEND_MS 뒤로 닫기 시점 미룸 */
+void Dwell_Extend(uint32_t now);
+
+/**
+ * @brief  DOOR_WAIT 동안 매 루프 호출
+ * @param  beamBlocked : 빔이 끊겨 있는지 (센서가 꺼져 있으면 false)
+ * @param  callSeq     : 현재 카 호출 순번 (Dwell_Begin 이후 늘었으면 연장)
+ * @retval true : 닫을 시간
+ */
+bool Dwell_Task(uint32_t now, bool beamBlocked, uint8_t callSeq);
+
+/**
+ * @brief  대기 종료(닫기 시작) 기록
+ * @param  closeBtn : CLOSE 버튼으로 닫았는지
+ * @retval 이번 대기 시간(ms)
+ */
+uint32_t Dwell_End(uint32_t now, bool closeBtn);
+
+/* CLOSE 버튼을 받아들일지 (빔이 끊겨 있으면 무시) */
+bool Dwell_CanClose(bool beamBlocked);
+
+/* 닫히는 중 빔 상태 판정: 끊겼으면 되열기(통계 기록) 후 true */
+bool Dwell_ShouldReopen(bool beamBlocked);
+
+/* 마지막 대기의 기준/활동 (로그용) */
+bool Dwell_IsHall(void);
+uint8_t Dwell_GetCalls(void);
+
+void Dwell_GetStats(dwell_stats_t *out);
+void Dwell_ResetStats(void);
+
+
+#endif /* INC_DWELL_H_ */
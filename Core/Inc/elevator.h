@@ -10,6 +10,8 @@
 
 
 #include "stm32f4xx_hal.h"
+#include "dwell.h"
+#include "stepper.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -20,8 +22,9 @@ typedef enum
   ELEVATOR_MOVING_DOWN,
   ELEVATOR_DOOR_OPENING,
   ELEVATOR_DOOR_WAIT,
-  ELEVATOR_DOOR_CLOSING,
-  ELEVATOR_EMG
+  ELEVATOR_DOOR_CLOSING,   // 같은 층 호출/OPEN 버튼이면 닫히던 위치에서 바로 DOOR_OPENING
+  ELEVATOR_EMG,
+  ELEVATOR_CALIBRATING   // 승강로 학습 주행(1층 -> 3층 -> 1층)
 } ELEVATOR_STATE;
 
 void Elevator_Init(void);
@@ -33,7 +36,27 @@ uint8_t Elevator_GetCurrentFloor(void);
 ELEVATOR_STATE Elevator_GetState(void);
 
 void Elevator_ResumeFromEMG(void);
+
+/* 캘리브레이션 주행 요청 (UART ISR에서도 호출 가능, IDLE이 되면 시작) */
+void Elevator_RequestCalibration(void);
+
+/* 스텝모터 설정 변경 요청 (UART ISR에서도 호출 가능, IDLE + 모터 정지에서 Elevator_Task가 적용)
+ * @retval false : 잘못된 모드 */
+bool Elevator_RequestDriveMode(stepper_drive_t mode);
+bool Elevator_RequestProfileMode(stepper_profile_t mode);   // 가속 테이블 재계산
+void Elevator_RequestStepDma(bool enable);                  // DMA 스텝 타이밍 (채널에 스트림이 없으면 적용 시 ERR)
 void Elevator_GetQueueString(char *out, uint32_t out_sz);
 
+/* 문 미리 열기: 레벨링 중 목표층 센서 창 안 + 정지 목표까지 이 거리(half-step) 이하이면
+ * 문 열기 시작 (0=끔) */
+void Elevator_SetAdvanceOpenSteps(uint16_t steps);
+uint16_t Elevator_GetAdvanceOpenSteps(void);
+
+/* 문 열림 대기(dwell) 통계: DOOR_WAIT에서 닫기 시작할 때마다 누적 (dwell.h) */
+typedef dwell_stats_t elevator_dwell_stats_t;
+
+void Elevator_GetDwellStats(elevator_dwell_stats_t *out);
+void Elevator_ResetDwellStats(void);   // UART ISR에서도 호출 가능 (Elevator_Task에서 적용)
+
 
 #endif /* INC_ELEVATOR_H_ */
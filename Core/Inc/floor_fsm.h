@@ -3,42 +3,61 @@
  *
  *  Created on: Feb 9, 2026
  *      Author: parkdoyoung
+ *
+ *  - 포토센서 RAW 비트 -> 층/구간 상태 디코더 (photo.c, shaft.c, UART 공용)
+ *  - 승강로 센서 배치를 표(s_layout)로 선언하고, 초기화 때
+ *    2^N 크기 룩업 테이블을 만들어 디코드는 배열 한 번 읽기로 끝낸다.
+ *  - 층을 늘리려면: FLOOR_FSM_SENSORS, 아래 enum, floor_fsm.c의 배치 표만 수정
  */
 
 #ifndef INC_FLOOR_FSM_H_
 #define INC_FLOOR_FSM_H_
 
 
-
-
-
-
-
-
 #include <stdint.h>
 
-/* 포토 기반 층 상태 */
-typedef enum
-{
-  FS_UNKNOWN = 0,
 
-  FS_F1,
-  FS_F2,
-  FS_F3,
-
-  FS_MOVE_1_2,   // 1~2 사이 (P1=1,P2=1,P3=0)
-  FS_MOVE_2_3,   // 2~3 사이 (P1=0,P2=1,P3=1)
-
-  FS_ERROR        // 이상한 조합(예: P1=1,P3=1)
-} floor_state_t;
-
-floor_state_t FloorFSM_Decode(uint8_t p1, uint8_t p2, uint8_t p3);
-const char* FloorFSM_ToString(floor_state_t s);
+/* 포토센서 개수 = 층 수 (센서 i는 RAW의 bit i, i=0이 1층) */
+#define FLOOR_FSM_SENSORS  3
+#define FLOOR_FSM_RAW_MASK ((1U << FLOOR_FSM_SENSORS) - 1U)
 
 
+/* ==============================
+ *        포토 상태(FSM)
+ * ==============================
+ * PF_UNKNOWN : RAW=000 등 "아무것도 감지 안됨" (이동중 표시로 사용)
+ * PF_F1/F2/F3: 해당 층 센서 1개만 감지됨
+ * PF_MOVE_*  : 이웃한 두 센서가 동시에 감지되는 구간(층 사이)
+ * PF_ERROR   : 배치 표에 없는 조합(예: p1&p3 같이 말이 안되는 조합)
+ */
+typedef enum {
+  PF_UNKNOWN = 0,
+  PF_F1,
+  PF_F2,
+  PF_F3,
+  PF_MOVE_1_2,
+  PF_MOVE_2_3,
+  PF_ERROR,
+  PF_COUNT
+} photo_fsm_t;
+
+
+/**
+ * @brief  배치 표로 룩업 테이블 생성 (Photo_Init에서 1회 호출)
+ */
+void FloorFSM_Init(void);
 
+/**
+ * @brief  RAW 비트(bit i = 센서 i+1 감지) -> 상태
+ */
+photo_fsm_t FloorFSM_Decode(uint8_t raw);
 
+/**
+ * @brief  확정층 상태면 층 번호(1~), 층 사이/이상이면 0
+ */
+uint8_t FloorFSM_FloorOf(photo_fsm_t s);
 
+const char* FloorFSM_ToString(photo_fsm_t s);
 
 
 #endif /* INC_FLOOR_FSM_H_ */
@@ -87,8 +87,9 @@ static const uint8_t NUM_PATTERNS[] = {
 void setFndState(uint8_t floor, uint8_t isDoorOpen);
 
 /**
- * @brief FND 화면을 갱신한다. (블로킹, 약 10ms 소요)
- * @note  잔상 효과를 위해 while(1) 루프에서 지속적으로 호출되어야 한다.
+ * @brief FND 한 자리를 갱신한다. (논 블로킹, 호출마다 다음 자리로 이동)
+ * @note  TIM3 업데이트 인터럽트(2.5ms)에서 호출된다. main loop에서 호출하지 말 것.
+ *        4자리 x 2.5ms = 10ms 주기(100Hz)로 전체 화면이 갱신된다.
  */
 void displayScan(void);
 
@@ -0,0 +1,69 @@
+/*
+ * param.h
+ *
+ *  - 비휘발 설정값(파라미터) 저장 모듈
+ *  - 내부 FLASH 마지막 섹터(Sector 7, 0x08060000, 128KB)에 구조체 하나를 통째로 저장
+ *  - 링커 스크립트의 FLASH 길이를 384K로 줄여 코드와 겹치지 않게 함
+ *
+ *  주의:
+ *  - 섹터 지우기는 1~2초 걸리고 그동안 FLASH에서 실행되는 코드(ISR 포함)가 멈춘다.
+ *    모터 정지 상태에서만 Param_Save()를 호출할 것.
+ */
+
+#ifndef INC_PARAM_H_
+#define INC_PARAM_H_
+
+
+#include "stm32f4xx_hal.h"
+#include "shaft.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+#define PARAM_FLASH_ADDR     0x08060000UL
+#define PARAM_FLASH_SECTOR   FLASH_SECTOR_7
+
+#define PARAM_MAGIC          0x50564C45UL   // "ELVP"
+#define PARAM_VERSION        2              // 구조체가 바뀌면 올림(이전 데이터는 무효)
+
+
+/* ==============================
+ *        저장 구조체
+ * ==============================
+ * crc는 항상 마지막 필드 (앞부분 전체에 대한 CRC32)
+ */
+typedef struct
+{
+  uint32_t    magic;
+  uint32_t    version;
+
+  shaft_map_t shaft;     // 승강로 지도(캘리브레이션 결과)
+  uint16_t    cruiseSps[2];   // 학습된 방향별 CRUISE [0]=UP, [1]=DOWN (0=미학습)
+
+  uint32_t    crc;
+} param_t;
+
+
+/**
+ * @brief  FLASH에서 파라미터 읽기 (없거나 깨졌으면 기본값)
+ */
+void Param_Init(void);
+
+/**
+ * @brief  FLASH에서 유효한 값을 읽었는지(또는 저장했는지)
+ */
+bool Param_IsValid(void);
+
+/**
+ * @brief  RAM 사본 (수정 후 Param_Save로 저장)
+ */
+param_t* Param_Get(void);
+
+/**
+ * @brief  RAM 사본을 FLASH에 저장 (섹터 지우기 + 쓰기, 블로킹)
+ * @retval true : 저장 및 검증 성공
+ */
+bool Param_Save(void);
+
+
+#endif /* INC_PARAM_H_ */
@@ -6,7 +6,8 @@
  *
  *  - 포토센서(층 감지) 모듈
  *  - 3개의 포토센서 조합으로 1/2/3층 + 이동구간(1~2, 2~3)을 판별
- *  - EXTI 인터럽트로 변화 감지 + 디바운스 + 백업 폴링(미스 대비)
+ *  - EXTI에서 센서별 에지(1us 타임스탬프 + 핀 상태)를 큐에 넣고,
+ *    Task에서 꺼내 글리치 필터 후 상태 확정 + 백업 폴링(미스 대비)
  */
 
 #ifndef INC_PHOTO_H_
@@ -14,27 +15,28 @@
 
 
 #include "stm32f4xx_hal.h"
+#include "floor_fsm.h"   // photo_fsm_t, RAW -> 상태 디코더
+#include <stdbool.h>
 #include <stdint.h>
 
 
+#define PHOTO_SENSORS  FLOOR_FSM_SENSORS
+
 
 /* ==============================
- *        포토 상태(FSM)
+ *        센서 에지 이벤트
  * ==============================
- * PF_UNKNOWN : RAW=000 등 "아무것도 감지 안됨" (이동중 표시로 사용)
- * PF_F1/F2/F3: 해당 층 센서 1개만 감지됨
- * PF_MOVE_*  : 두 센서가 동시에 감지되는 구간(층 사이)
- * PF_ERROR   : 비정상 조합(예: p1&p3 같이 말이 안되는 조합)
- */
-typedef enum {
-  PF_UNKNOWN = 0,
-  PF_F1,
-  PF_F2,
-  PF_F3,
-  PF_MOVE_1_2,
-  PF_MOVE_2_3,
-  PF_ERROR
-} photo_fsm_t;
+ * us       : TIM5(32bit, 1MHz free-running) 카운터 값, 약 71분마다 한 바퀴
+ *            (차이는 항상 uint32_t 뺄셈으로 계산)
+ * sensor   : 0~PHOTO_SENSORS-1 (0 = 1층 센서)
+ * detected : 에지 직후 핀 상태 (1 = 빔 끊김/감지)
+ */
+typedef struct
+{
+  uint32_t us;
+  uint8_t  sensor;
+  uint8_t  detected;
+} photo_edge_t;
 
 void Photo_Init(void);
 
@@ -42,6 +44,8 @@ void Photo_Init(void);
 /**
  * @brief EXTI 콜백에서 호출 (어떤 포토 핀에서 인터럽트가 났는지 전달)
  * @note  현재 구현은 GPIO_Pin 값으로만 판별(포트까지는 확인하지 않음)
+ *
+ * 타임스탬프와 핀 상태를 바로 읽어 에지 큐에 넣는다(큐가 가득 차면 버리고 카운트).
  */
 void Photo_OnExti(uint16_t GPIO_Pin);
 
@@ -54,6 +58,29 @@ uint8_t Photo_Task(void);
 
 void Photo_GetRaw(uint8_t *p1, uint8_t *p2, uint8_t *p3);
 photo_fsm_t Photo_GetFSM(void);
-const char* Photo_FSM_ToString(photo_fsm_t f);
+
+/**
+ * @brief  현재 us 타임스탬프 (TIM5 카운터)
+ */
+uint32_t Photo_NowUs(void);
+
+/**
+ * @brief  현재 상태(Photo_GetFSM)를 만든 에지의 타임스탬프(us)
+ *
+ * Photo_Task가 상태를 확정한 시각이 아니라 센서가 실제로 바뀐 시각.
+ * 백업 폴링으로 잡힌 변화는 폴링 시각.
+ */
+uint32_t Photo_GetStateUs(void);
+
+/**
+ * @brief  센서별 마지막 에지 (센서 간 시간차로 속도 추정용)
+ * @retval false : 아직 에지 없음
+ */
+bool Photo_GetLastEdge(uint8_t sensor, photo_edge_t *out);
+
+/**
+ * @brief  큐가 가득 차서 버린 에지 수
+ */
+uint32_t Photo_GetEdgeDrops(void);
 
 #endif /* INC_PHOTO_H_ */
@@ -8,6 +8,9 @@
  *  서보모터 제어 모듈 (엘리베이터 문 제어용)
  *  - PWM(TIM1 CH1) 기반 제어
  *  - 논블로킹 방식 (Servo_Run을 주기적으로 호출)
+ *  - 위치는 루프 주기와 무관하게 "이동 시작 후 경과 시간"으로 계산 (이징 곡선 적용)
+ *  - 이동 시작 시 PWM 주기마다의 CCR1 값을 미리 계산해 두고,
+ *    TIM1 업데이트 이벤트 DMA(DMA2 Stream5)가 주기당 1개씩 CCR1에 써 넣는다
  */
 
 #ifndef INC_SERVO_H_
@@ -24,17 +27,46 @@
 
 
 /* ==============================
- *   서보 위치 값 (CCR1 값 기준)
+ *   서보 위치 값 (펄스 폭, us)
  * ==============================
- * TIM1->CCR1 값으로 서보 각도 제어
+ * TIM1은 1MHz(1us/카운트), 주기 20000(20ms)이므로 CCR1 값 = 펄스 폭(us)
  *
- * SERVO_LEFT  : 문 닫힘 위치
- * SERVO_RIGHT : 문 열림 위치
+ * SERVO_CLOSED_US_DEFAULT : 문 닫힘 위치 (기존 CCR 40 @10us)
+ * SERVO_OPENED_US_DEFAULT : 문 열림 위치 (기존 CCR 240 @10us)
  *
- * ※ PWM 주기 설정에 따라 값은 조정 가능
+ * 실제 끝 위치는 기구에 맞춰 Servo_SetEndpoints로 1us 단위 보정 가능
+ * (닫힘 > 열림으로 설정해 서보 장착 방향을 뒤집는 것도 허용)
  */
-#define SERVO_LEFT   40    // 닫힘
-#define SERVO_RIGHT  240   // 열림
+#define SERVO_CLOSED_US_DEFAULT  400
+#define SERVO_OPENED_US_DEFAULT  2400
+#define SERVO_PULSE_US_MIN       300    // 일반 RC 서보 허용 범위
+#define SERVO_PULSE_US_MAX       2700
+
+
+/* ==============================
+ *     문 이동 시간 / 이징 곡선
+ * ==============================
+ * 전체 스트로크(닫힘 <-> 열림)에 걸리는 시간(ms). 중간 위치에서 출발하면
+ * 남은 거리 비율만큼 줄어든다. 런타임에 Servo_SetStrokeTime으로 변경 가능.
+ *
+ * LINEAR   : 등속 (기존 방식과 같은 모양)
+ * SMOOTH   : 3t^2 - 2t^3, 양 끝 속도 0, 중간 속도 1.5배
+ * SMOOTHER : 6t^5 - 15t^4 + 10t^3, 양 끝 속도/가속도 0, 중간 속도 1.9배
+ */
+#define SERVO_OPEN_MS_DEFAULT    1500
+#define SERVO_CLOSE_MS_DEFAULT   2000   // 닫힘은 끼임 대비 조금 느리게
+#define SERVO_STROKE_MS_MIN      300    // 서보 자체 최고 속도(~0.3s/180도) 이하로는 무의미
+#define SERVO_STROKE_MS_MAX      10000
+
+#define SERVO_FRAME_MS           20     // TIM1 PWM 주기 = 궤적 샘플 간격
+#define SERVO_TRAJ_MAX           (SERVO_STROKE_MS_MAX / SERVO_FRAME_MS + 1)
+
+typedef enum
+{
+    SERVO_EASE_LINEAR = 0,
+    SERVO_EASE_SMOOTH,
+    SERVO_EASE_SMOOTHER
+} servo_ease_t;
 
 
 
@@ -53,12 +85,31 @@ typedef enum
  *         API 함수
  * ============================== */
 void Servo_Init(void);     // 초기화 (기본 닫힘 상태)
-void Servo_Open(void);     // 문 열기
-void Servo_Close(void);    // 문 닫기
+void Servo_Open(void);     // 문 열기 (닫히는 중이면 현재 위치에서 바로 반전)
+void Servo_Close(void);    // 문 닫기 (열리는 중이면 현재 위치에서 바로 반전)
 void Servo_Run(void);      // 논블로킹 이동 처리 (주기 호출)
 
-bool Servo_IsOpened(void); // 완전 열림 여부
-bool Servo_IsClosed(void); // 완전 닫힘 여부
+/**
+ * @brief  열림/닫힘 전체 스트로크 시간 설정 (다음 이동부터 적용)
+ * @retval false : SERVO_STROKE_MS_MIN ~ MAX 범위 밖
+ */
+bool Servo_SetStrokeTime(uint16_t open_ms, uint16_t close_ms);
+void Servo_GetStrokeTime(uint16_t *open_ms, uint16_t *close_ms);
+
+bool Servo_SetEasing(servo_ease_t ease);   // 다음 이동부터 적용
+servo_ease_t Servo_GetEasing(void);
+
+/**
+ * @brief  닫힘/열림 끝 위치(펄스 폭, us) 보정 (문이 멈춰 있을 때만)
+ * @retval false : 이동 중이거나 SERVO_PULSE_US_MIN ~ MAX 범위 밖, 또는 두 값이 같음
+ *
+ * 문이 끝 위치에 서 있었다면 새 끝 위치로 이징 이동한다.
+ */
+bool Servo_SetEndpoints(uint16_t closed_us, uint16_t opened_us);
+void Servo_GetEndpoints(uint16_t *closed_us, uint16_t *opened_us);
+
+bool Servo_IsOpened(void); // 완전 열림 여부 (열림 끝에 멈춰 있음)
+bool Servo_IsClosed(void); // 완전 닫힘 여부 (닫힘 끝에 멈춰 있음, 이동 중이면 false)
 
 
 
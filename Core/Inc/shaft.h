@@ -0,0 +1,151 @@
+/*
+ * shaft.h
+ *
+ *  - 승강로(shaft) 감시 모듈
+ *  - 포토 상태가 바뀔 때마다 스텝모터 절대 위치를 기록하고,
+ *    포토 상태(구간)별로 "그 구간을 지나는 데 걸리는 스텝 수"를 학습한다.
+ *  - 이동 중 현재 구간에서 학습값보다 너무 많이 스텝했는데도 다음 포토 변화가
+ *    없으면 탈조/정지(STALL)로 판단 -> MOVE_TIMEOUT(20s)보다 훨씬 빨리 감지
+ *  - 캘리브레이션 주행으로 층 구간 경계 위치(shaft map)를 기록하고,
+ *    이후에는 경계를 지날 때마다 절대 위치를 map 기준으로 재보정한다.
+ */
+
+#ifndef INC_SHAFT_H_
+#define INC_SHAFT_H_
+
+
+#include "photo.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/* ==============================
+ *        판정 기준
+ * ==============================
+ * 허용 스텝 = 학습값 * (100 + TOL) / 100 + MARGIN
+ * - MARGIN은 Photo_Task 백업 폴링 지연(최대 ~50ms, EXTI 놓쳤을 때) 동안 진행한 스텝 흡수용
+ * - 단위는 모두 half-step (Stepper_GetPosition 기준)
+ */
+#define SHAFT_TOL_PCT        15
+#define SHAFT_MARGIN_STEPS   48
+
+
+/* ==============================
+ *        승강로 지도(shaft map)
+ * ==============================
+ * 층 f(1~3)의 포토 구간(PF_Fx)이 시작/끝나는 절대 위치(half-step)
+ * - lo : 구간의 아래쪽 경계,  hi : 위쪽 경계
+ * - [방향] 인덱스 0=DIR_UP으로 지날 때, 1=DIR_DOWN으로 지날 때
+ *   (센서 히스테리시스/검출 지연이 방향마다 달라서 따로 저장)
+ * - 1층 lo, 3층 hi는 주행 범위 밖이라 SHAFT_POS_NONE
+ */
+#define SHAFT_FLOORS    3
+#define SHAFT_POS_NONE  INT32_MIN
+
+typedef struct
+{
+  int32_t lo[2][SHAFT_FLOORS + 1];   // [dir][floor], floor 0은 사용 안함
+  int32_t hi[2][SHAFT_FLOORS + 1];
+  uint32_t valid;                     // 1: 캘리브레이션 완료
+} shaft_map_t;
+
+
+/* ==============================
+ *        이상 종류
+ * ==============================
+ * SHAFT_FAULT_STALL : 다음 포토 변화 없이 허용 스텝 초과 (정지/탈조/스텝 누락)
+ * SHAFT_FAULT_EARLY : 학습값보다 너무 일찍 포토 변화 (센서 튐/오학습 의심)
+ */
+typedef enum
+{
+  SHAFT_FAULT_NONE = 0,
+  SHAFT_FAULT_STALL,
+  SHAFT_FAULT_EARLY
+} shaft_fault_t;
+
+
+void Shaft_Init(void);
+
+/**
+ * @brief  엘리베이터가 새 이동을 시작할 때 호출 (Stepper_Start* 직후)
+ * @param  dir : DIR_UP 또는 DIR_DOWN
+ *
+ * 현재 위치를 구간 기준점으로 잡는다. 정지 상태에서 출발한 첫 구간은
+ * 일부만 지나가므로 학습하지 않고, STALL 판정에만 사용한다.
+ */
+void Shaft_OnMoveStart(uint8_t dir);
+
+/**
+ * @brief  포토 상태가 바뀌었을 때 호출 (Photo_Task()가 1을 반환한 직후)
+ * @param  now : 새 포토 상태
+ *
+ * 직전 구간을 지나는 동안의 스텝 수를 학습하거나, 너무 짧으면 EARLY로 표시.
+ */
+void Shaft_OnPhotoEdge(photo_fsm_t now);
+
+/**
+ * @brief  주기 호출 Task (main 루프)
+ *
+ * 이동 중이면 현재 구간에서 진행한 스텝 수를 허용치와 비교해 STALL을 판정.
+ * 모터가 멈춰 있으면(도착/EMG 등) 판정하지 않는다.
+ */
+void Shaft_Task(void);
+
+shaft_fault_t Shaft_GetFault(void);
+void Shaft_ClearFault(void);
+
+/**
+ * @brief  학습된 구간 스텝 수 (0이면 아직 학습 안됨)
+ * @param  dir : DIR_UP 또는 DIR_DOWN 방향으로 통과할 때의 값
+ */
+uint32_t Shaft_GetExpectedSteps(photo_fsm_t seg, uint8_t dir);
+
+const char* Shaft_FaultToString(shaft_fault_t f);
+
+
+/* ==============================
+ *        캘리브레이션 / 지도
+ * ============================== */
+
+/**
+ * @brief  캘리브레이션 기록 시작 (현재 위치가 좌표 원점이 된 직후 호출)
+ *
+ * 이후 이동 중 포토 변화마다 층 구간 경계 위치를 map에 기록한다.
+ */
+void Shaft_CalBegin(void);
+
+/**
+ * @brief  캘리브레이션 종료
+ * @param  ok : false면 기록을 버리고 기존 map 유지
+ * @retval true : 필요한 경계가 모두 기록되어 map을 갱신/저장함
+ */
+bool Shaft_CalEnd(bool ok);
+
+bool Shaft_IsCalibrating(void);
+
+/**
+ * @brief  현재 shaft map (valid=0이면 미보정)
+ */
+const shaft_map_t* Shaft_GetMap(void);
+
+/**
+ * @brief  절대 위치가 map 좌표계와 맞춰졌는지 여부
+ *
+ * 부팅 직후에는 위치가 0부터 시작하므로 false,
+ * 이동 중 map에 있는 경계를 한 번 지나면 true.
+ */
+bool Shaft_IsReferenced(void);
+
+/**
+ * @brief  층 센서 창(PF_Fx 구간)의 중앙 위치
+ * @param  floor  : 1~3
+ * @param  center : 결과(half-step, map 좌표)
+ * @retval false : map 없음
+ *
+ * 경계는 UP/DOWN 통과 값의 평균을 쓴다. 주행 범위 끝 층(1층/3층)은
+ * 한쪽 경계만 있으므로 양쪽 경계가 있는 층의 창 폭 절반을 적용한다.
+ */
+bool Shaft_GetFloorCenter(uint8_t floor, int32_t *center);
+
+
+#endif /* INC_SHAFT_H_ */
@@ -5,8 +5,9 @@
  *      Author: parkdoyoung
  *
  *  STEP 모터(4상) 구동 모듈
- *  - HAL_GetTick() 기반 논블로킹 방식
- *  - Stepper_Task()를 주기적으로 호출하면 설정된 방향으로 계속 회전
+ *  - TIM4 출력비교 인터럽트 기반 스텝 발생 (1us 분해능, 모터마다 비교 채널 1개)
+ *  - 모터별 상태는 stepper_t 인스턴스에 두고 모든 API가 인스턴스 포인터를 받는다
+ *  - Start/Stop은 타이머 인터럽트를 켜고 끄기만 하고, 실제 상 출력은 ISR에서 수행
  */
 
 #ifndef INC_STEPPER_H_
@@ -35,10 +36,11 @@
 
 /*
  * ==============================
- *     스텝모터 제어 핀 매핑
+ *   카(1번) 스텝모터 제어 핀 매핑
  * ==============================
  * 4상(HALF STEP) 제어용 GPIO 정의
  * 각 INx는 드라이버 입력 또는 ULN2003 입력과 연결
+ * 다른 모터(2번 카/보조 축)는 stepper_hw_t에 자기 핀을 넣어 Stepper_Init에 넘긴다.
  */
 #define IN1_PORT GPIOA
 #define IN1_PIN  GPIO_PIN_4
@@ -53,52 +55,418 @@
 #define IN4_PIN  GPIO_PIN_0
 
 
+/*
+ * ==============================
+ *     스텝 주기 / 가감속 설정
+ * ==============================
+ * TIM4는 1MHz(1us/카운트)로 free-running 하며,
+ * CH1 비교값을 스텝 간격만큼 밀어가며 스텝을 발생시킨다.
+ *
+ * 속도 단위는 sps(steps/s, 현재 구동 모드의 스텝 기준), 가속도는 sps/s.
+ * (FULL/WAVE는 한 스텝이 2 half-step이므로 같은 sps에서 선속도가 2배)
+ * - START  : 정지 상태에서 탈조 없이 바로 낼 수 있는 속도(pull-in 이하)
+ * - CRUISE : 가속 완료 후 등속 구간 속도(pull-in 이상도 가능)
+ * - ACCEL  : 가속/감속 기울기
+ *
+ * STEP_PERIOD_US_MIN : ISR 부하/탈조 방지용 스텝 간격 하한
+ * STEPPER_RAMP_MAX   : 가속 테이블 최대 길이(스텝)
+ */
+#define STEPPER_START_SPS_DEFAULT   400
+#define STEPPER_CRUISE_SPS_DEFAULT  900
+#define STEPPER_ACCEL_DEFAULT       1500
+#define STEPPER_JERK_DEFAULT        6000   // sps/s^2, S-curve 전용
+
+#define STEPPER_START_SPS_MIN       16     // 간격이 16bit(us)에 들어가야 함
+#define STEP_PERIOD_US_MIN          200
+#define STEPPER_RAMP_MAX            512
+#define STEPPER_DMA_BUF             64     // DMA 타이밍 버퍼(짝수), 절반씩 재충전
+
+/*
+ * ==============================
+ *     코일 전원(홀드 전류) 관리
+ * ==============================
+ * 정지 후 STEPPER_HOLD_SETTLE_MS 동안 100% 홀드, 이후
+ * - 주차(IDLE + 문 닫힘) : 코일 OFF
+ * - 그 외(문 동작 중 등): TIM4 CH2 초핑으로 감전류 홀드 (ON/PERIOD 듀티)
+ * STEPPER_COIL_MW : 코일 1개 ON 시 추정 소비전력 (28BYJ-48 5V, 약 50옴 -> 0.5W)
+ */
+#define STEPPER_HOLD_SETTLE_MS      500
+#define STEPPER_CHOP_PERIOD_US      1000   // 1kHz
+#define STEPPER_CHOP_ON_US          250    // 25% 듀티
+#define STEPPER_COIL_MW             500
+
+/* 비상 감속: 평상시 가속도의 몇 배로 감속할지 / 기본 최대 정지 거리(half-step) */
+#define STEPPER_EMG_DECEL_MULT      4
+#define STEPPER_EMG_MAX_STEPS       160
+
+
+/*
+ * ==============================
+ *      가감속 프로파일 모드
+ * ==============================
+ * CONSTANT  : 가감속 없이 START 속도로 등속 (기존 방식)
+ * TRAPEZOID : 일정 가속도로 CRUISE까지 가속/감속 (기본값)
+ * SCURVE    : 가속도 자체를 JERK로 서서히 올리고 내림 (충격/공진 감소)
+ */
+typedef enum
+{
+  STEPPER_PROFILE_CONSTANT = 0,
+  STEPPER_PROFILE_TRAPEZOID,
+  STEPPER_PROFILE_SCURVE
+} stepper_profile_t;
+
+
+/*
+ * ==============================
+ *        구동 모드
+ * ==============================
+ * HALF : 1-2상 여자(half-step), 분해능 최대 (기본값)
+ * FULL : 2상 여자(full-step), 토크 최대, 같은 sps에서 속도 2배
+ * WAVE : 1상 여자(wave drive), 소비 전류 최소, 같은 sps에서 속도 2배
+ *
+ * 위치/이동 거리 API는 모드와 무관하게 항상 half-step 단위를 쓴다.
+ * FULL/WAVE에서는 한 스텝이 2 half-step이라 위치의 홀짝이 바뀌지 않으므로,
+ * 목표 위치/거리는 현재 위치와 홀짝이 같은(짝수 차이) 값이어야 정확히 도달한다.
+ * 홀수 차이는 세 이동 API 모두 같은 규칙으로 반올림(1 half-step 지나침)한다.
+ */
+typedef enum
+{
+  STEPPER_DRIVE_HALF = 0,
+  STEPPER_DRIVE_FULL,
+  STEPPER_DRIVE_WAVE
+} stepper_drive_t;
+
+
+/*
+ * ==============================
+ *        코일 전원 상태
+ * ============================== */
+typedef enum
+{
+  STEPPER_POWER_RUN = 0,   // 회전 중
+  STEPPER_POWER_HOLD,      // 100% 홀드(정지 직후)
+  STEPPER_POWER_REDUCED,   // 초핑 감전류 홀드
+  STEPPER_POWER_OFF,       // 코일 OFF(주차)
+  STEPPER_POWER_COUNT
+} stepper_power_t;
+
+/* 상태별 누적 시간/추정 에너지 */
+typedef struct
+{
+  uint32_t ms[STEPPER_POWER_COUNT];
+  uint32_t mj[STEPPER_POWER_COUNT];
+} stepper_power_stats_t;
+
+
+/*
+ * ==============================
+ *     모터 인스턴스(stepper_t)
+ * ==============================
+ * 모터마다 stepper_t 하나를 정적으로 잡고 Stepper_Init으로 핀/채널을 지정한다.
+ * - TIM4 하나를 모든 모터가 공유(1us free-running), 모터마다 비교 채널 1개
+ *   CH1/CH3/CH4 -> 스텝 타이밍, CH2 -> 감전류 홀드 초핑(모든 모터 공용)
+ * - TIM4 비교 인터럽트는 Stepper_OnTimerIrq() 하나가 채널로 인스턴스를 찾아 처리
+ * - DMA 타이밍 모드는 DMA 스트림이 연결된 채널(현재 CH1)에서만 가능
+ *
+ * 필드는 정적 할당을 위해 공개할 뿐, 외부에서는 API로만 접근할 것.
+ * (ISR과 공유하는 필드는 volatile)
+ */
+#define STEPPER_MAX_PORTS      4     // 한 모터의 IN1~IN4가 걸칠 수 있는 최대 포트 수
+#define STEPPER_TIM_CHANNELS   4     // TIM4 비교 채널 수
+
+typedef struct
+{
+  GPIO_TypeDef *port[4];   // IN1~IN4
+  uint16_t      pin[4];
+  uint32_t      channel;   // TIM_CHANNEL_1/3/4 (TIM_CHANNEL_2는 초핑 전용)
+} stepper_hw_t;
+
+typedef struct
+{
+  /* 하드웨어 / phase별 BSRR 출력 워드 */
+  stepper_hw_t  hw;
+  uint8_t       chIdx;                               // 0~3 (TIM_CHANNEL_x / 4)
+  GPIO_TypeDef *ports[STEPPER_MAX_PORTS];
+  uint8_t       portCount;
+  uint32_t      phaseBsrr[8][STEPPER_MAX_PORTS];
+  uint32_t      offBsrr[STEPPER_MAX_PORTS];         // 모든 코일 OFF
+
+  /* 구동 모드 */
+  stepper_drive_t driveMode;
+  uint8_t         stride;                            // 한 스텝당 phase/위치 증가량(half-step)
+
+  /* 이동 상태 */
+  uint8_t           stepIndex;                       // 현재 phase(0~7), ISR 전용
+  volatile bool     busy;
+  volatile uint8_t  dir;
+  volatile uint32_t stepsDone;
+  volatile uint32_t stepsTotal;                      // 0이면 연속 회전
+  volatile int32_t  position;                        // 절대 위치(half-step, 위쪽이 +)
+
+  /* 가감속 테이블 */
+  uint16_t          ramp[STEPPER_RAMP_MAX];
+  volatile uint16_t rampLen;
+  volatile uint16_t cruiseUs;
+  volatile uint16_t startUs;
+  volatile bool     creepAfter;
+
+  /* 비상 감속 */
+  volatile bool     emgActive;
+  volatile uint32_t emgIdx;
+  volatile uint32_t emgLeft;
+  int32_t           emgStartPos;
+  volatile uint32_t emgSteps;
+
+  /* 프로파일 설정값 */
+  stepper_profile_t profileMode;
+  uint16_t startSps;
+  uint16_t cruiseSps;
+  uint16_t dirCruise[2];                             // 방향별 CRUISE(0이면 cruiseSps)
+  uint16_t builtCruise;                              // 현재 테이블이 만들어진 CRUISE
+  uint16_t accel;
+  uint32_t jerk;
+
+  /* DMA 타이밍 */
+  uint16_t      dmaBuf[STEPPER_DMA_BUF];
+  volatile bool dmaMode;
+  bool          dmaActive;
+  uint32_t      planStep;
+  uint16_t      planTime;
+
+  /* 코일 전원 */
+  volatile stepper_power_t power;
+  uint32_t      powerTick;
+  uint32_t      pwrLastTick;
+  volatile bool parked;
+  uint32_t      pwrMs[STEPPER_POWER_COUNT];
+  uint64_t      pwrUj[STEPPER_POWER_COUNT];
+} stepper_t;
+
+
+/* 카(1번) 모터 인스턴스 (stepper.c에 정의) */
+extern stepper_t hstepper1;
+
+
 /*
  * ==============================
  *        함수 원형 선언
  * ==============================
+ * 모든 함수는 첫 인자로 대상 모터(stepper_t*)를 받는다.
  */
 
 /**
  * @brief  스텝모터 초기화
- *         내부 상태 변수 및 출력 핀 초기 설정
+ * @param  m  : 초기화할 인스턴스
+ * @param  hw : 핀/TIM4 채널 (내용을 복사하므로 호출 후 해제해도 됨)
+ * @retval false : 채널이 CH2(초핑용)거나 이미 다른 모터가 사용 중
+ *
+ * 내부 상태 변수 및 출력 핀 초기 설정, TIM4 채널 인터럽트 라우팅 등록.
  */
-void Stepper_Init(void);
+bool Stepper_Init(stepper_t *m, const stepper_hw_t *hw);
 
 /**
  * @brief  연속 회전 시작(논블로킹)
  * @param  dir : DIR_UP 또는 DIR_DOWN
  *
- * Stepper_Task()가 호출될 때마다 일정 주기(STEP_PERIOD_MS)로 한 스텝씩 진행
+ * TIM4 비교 인터럽트를 활성화만 한다.
+ * START 속도에서 출발해 가속 테이블을 따라 CRUISE 속도까지 가속 후 등속 유지.
  */
-void Stepper_StartContinuous(uint8_t dir);
+void Stepper_StartContinuous(stepper_t *m, uint8_t dir);
 
+/**
+ * @brief  지정 스텝 수만큼 사다리꼴 프로파일로 이동(논블로킹)
+ * @param  dir   : DIR_UP 또는 DIR_DOWN
+ * @param  steps : 이동할 half-step 수 (0이면 무시)
+ *
+ * FULL/WAVE 모드에서는 2 half-step 단위로 반올림된다 (MoveTo/MoveToCreep와 같음).
+ * 가속 -> 등속 -> 감속 후 스스로 정지한다. 짧은 이동은 삼각형 프로파일이 된다.
+ * 완료 여부는 Stepper_IsBusy()로 확인.
+ */
+void Stepper_MoveProfile(stepper_t *m, uint8_t dir, uint32_t steps);
 
 /**
- * @brief  회전 정지
+ * @brief  가감속 프로파일 설정 (정지 상태에서만 허용)
+ * @param  start_sps  : 시작 속도(sps), STEPPER_START_SPS_MIN 이상
+ * @param  cruise_sps : 등속 속도(sps), start_sps 이상
+ * @param  accel_sps2 : 가속도(sps/s), 0 불가
+ * @retval true  : 적용됨 (가속 테이블 재계산)
+ * @retval false : 회전 중이거나 인자 오류
+ *
+ * CRUISE는 STEP_PERIOD_US_MIN 및 STEPPER_RAMP_MAX 한도 내로 보정될 수 있다.
+ */
+bool Stepper_SetProfile(stepper_t *m, uint16_t start_sps, uint16_t cruise_sps, uint16_t accel_sps2);
+void Stepper_GetProfile(stepper_t *m, uint16_t *start_sps, uint16_t *cruise_sps, uint16_t *accel_sps2);
+
+/**
+ * @brief  방향별 CRUISE 속도 설정 (정지 상태에서만 허용)
+ * @param  dir        : DIR_UP 또는 DIR_DOWN
+ * @param  cruise_sps : 해당 방향 등속 속도(sps), 0이면 프로파일 CRUISE 사용
+ *
+ * 프로파일 CRUISE보다 높게도 설정 가능(STEP_PERIOD_US_MIN 한도).
+ * 가속 테이블은 이동 시작 시 방향에 맞게 다시 계산된다.
+ */
+bool Stepper_SetDirCruise(stepper_t *m, uint8_t dir, uint16_t cruise_sps);
+uint16_t Stepper_GetDirCruise(stepper_t *m, uint8_t dir);   // 실제 적용되는 값
+
+/**
+ * @brief  S-curve 저크 설정 (정지 상태에서만 허용)
+ * @param  jerk_sps3 : 가속도 변화율(sps/s^2), 0 불가
+ */
+bool Stepper_SetJerk(stepper_t *m, uint32_t jerk_sps3);
+
+/**
+ * @brief  가감속 프로파일 모드 선택 (정지 상태에서만 허용, 테이블 재계산)
+ * @retval true : 적용됨, false : 회전 중이거나 잘못된 모드
+ */
+bool Stepper_SetProfileMode(stepper_t *m, stepper_profile_t mode);
+stepper_profile_t Stepper_GetProfileMode(stepper_t *m);
+
+/**
+ * @brief  DMA 스텝 타이밍 모드 선택 (정지 상태에서만 허용)
+ * @param  enable : true면 TIM4 비교값을 DMA가 순환 버퍼에서 공급
+ * @retval false : 회전 중이거나, 이 모터의 채널에 DMA 스트림이 연결되어 있지 않음
+ *
+ * DMA 모드에서 스텝 ISR은 phase 출력/위치 갱신만 하고,
+ * 간격 계산은 버퍼 절반마다 DMA 콜백에서 몰아서 수행한다.
+ */
+bool Stepper_SetDmaMode(stepper_t *m, bool enable);
+bool Stepper_GetDmaMode(stepper_t *m);
+
+/**
+ * @brief  구동 모드 선택 (정지 상태에서만 허용)
+ * @retval true : 적용됨, false : 회전 중이거나 잘못된 모드
+ *
+ * 현재 phase가 새 모드에서 쓰지 않는 행이면 한 half-step 위로 맞추며,
+ * 이때 절대 위치도 +1 갱신된다.
+ */
+bool Stepper_SetDriveMode(stepper_t *m, stepper_drive_t mode);
+stepper_drive_t Stepper_GetDriveMode(stepper_t *m);
+
+
+/**
+ * @brief  절대 위치로 이동 (사다리꼴/S-curve 프로파일, 논블로킹)
+ * @param  target_steps : 목표 절대 위치(half-step)
+ * @retval true  : 이동 시작(또는 이미 목표 위치)
+ * @retval false : 회전 중이라 거부됨
+ */
+bool Stepper_MoveTo(stepper_t *m, int32_t target_steps);
+
+/**
+ * @brief  목표 위치까지 가감속 이동 후, 멈추지 않고 START 속도로 계속 회전(크립)
+ * @param  target_steps : 감속을 끝낼 절대 위치(half-step)
+ * @param  dir          : 진행 방향 (목표가 이미 뒤쪽이면 바로 크립)
+ * @retval false : 회전 중이라 거부됨
+ *
+ * 최종 정지는 호출 측이 센서를 보고 Stepper_Stop()으로 한다.
+ * (층 센서 직전까지 감속해 두고 센서에서 저속으로 멈추는 도착 방식)
+ */
+bool Stepper_MoveToCreep(stepper_t *m, int32_t target_steps, uint8_t dir);
+
+/**
+ * @brief  현재 절대 위치(half-step, DIR_UP 방향이 +)
+ * @note   ISR/main 어디서 호출해도 한 번의 32bit load라 값이 찢어지지 않음
+ */
+int32_t Stepper_GetPosition(stepper_t *m);
+
+/**
+ * @brief  현재 위치를 지정 값으로 재설정(기준점 보정용, 정지 중에만 반영)
+ */
+void Stepper_SetPosition(stepper_t *m, int32_t pos);
+
+/**
+ * @brief  현재 위치에 보정값을 더함 (회전 중에도 사용 가능, 짧게 IRQ 차단)
+ * @param  delta : 더할 half-step 수 (포토 경계 기준 재보정용)
+ */
+void Stepper_AdjustPosition(stepper_t *m, int32_t delta);
+
+/**
+ * @brief  회전 즉시 정지 (EMG/고장 처리용)
  *
  * 주의:
- * - 현재 구현은 phase 0 출력으로 "홀드(토크 유지)" 상태가 될 수 있음.
- * - 완전 OFF가 필요하면 모든 IN 핀을 RESET 하는 방식으로 변경해야 함.
+ * - 현재 속도와 상관없이 그 스텝에서 끊으므로 START(pull-in)보다 빠르면 탈조할 수 있다.
+ *   정상 정지는 Stepper_Decelerate()를 쓸 것.
+ * - 마지막 phase를 그대로 출력하므로 "홀드(토크 유지)" 상태가 됨.
+ * - 이후 감전류 홀드/코일 OFF 전환은 Stepper_Task()가 처리.
+ */
+void Stepper_Stop(stepper_t *m);
+
+/**
+ * @brief  감속 정지 (논블로킹, ISR에서도 호출 가능)
+ *
+ * 현재 속도의 가속 테이블 위치에서 평상시 가속도로 START 속도까지 감속한 뒤 정지한다.
+ * 연속 회전/크립 모두 가능하며, 이미 감속 중인 프로파일 이동은 그대로 둔다.
+ * 정지 완료는 Stepper_IsBusy()==false (그 전에 새 이동을 시작하지 말 것).
+ */
+void Stepper_Decelerate(stepper_t *m);
+
+
+/**
+ * @brief  비상 감속 정지 (논블로킹, ISR에서도 호출 가능)
+ * @param  max_steps : 최대 정지 거리(half-step). 이 안에 START 속도까지 못 내려오면
+ *                     남은 속도에서 바로 정지
+ *
+ * 현재 속도에서 가속도의 STEPPER_EMG_DECEL_MULT 배로 감속한 뒤 마지막 phase를 유지한다.
+ * 정지 완료는 Stepper_IsBusy()==false, 정지 거리는 Stepper_GetEmgStopSteps().
+ */
+void Stepper_EmergencyStop(stepper_t *m, uint32_t max_steps);
+bool Stepper_IsEmergencyStopping(stepper_t *m);
+
+/**
+ * @brief  마지막 비상 감속에서 실제로 이동한 거리(half-step)
+ */
+uint32_t Stepper_GetEmgStopSteps(stepper_t *m);
+
+
+/**
+ * @brief  코일 전원 관리 Task (main 루프에서 모터마다 주기 호출)
+ *
+ * 정지 후 경과 시간과 주차 여부에 따라 HOLD -> REDUCED/OFF로 전환하고,
+ * 상태별 시간/에너지를 누적한다. 다음 이동 시작 시 같은 phase를 먼저 복원한다.
+ */
+void Stepper_Task(stepper_t *m);
+
+/**
+ * @brief  주차 상태 알림 (엘리베이터 IDLE + 문 닫힘이면 true -> 코일 OFF 허용)
  */
-void Stepper_Stop(void);
+void Stepper_SetParked(stepper_t *m, bool parked);
+
+stepper_power_t Stepper_GetPowerState(stepper_t *m);
+void Stepper_GetPowerStats(stepper_t *m, stepper_power_stats_t *out);
 
 
 /**
- * @brief  주기적 호출용 Task(논블로킹)
+ * @brief  TIM4 비교 일치 시 호출 (ISR 컨텍스트, 모든 모터 공용)
+ * @param  active_channel : htim->Channel (HAL_TIM_ACTIVE_CHANNEL_x)
  *
- * main loop 또는 타이머 기반 task에서 자주 호출.
- * 내부에서 HAL_GetTick()으로 스텝 주기를 맞추며,
- * s_busy=true일 때만 실제 상(phase)을 갱신한다.
+ * HAL_TIM_OC_DelayElapsedCallback()에서 호출.
+ * CH2면 감전류 홀드 초핑, 그 외 채널은 등록된 모터의 스텝 1회 진행 + 다음 비교값 예약.
  */
-void Stepper_Task(void);
+void Stepper_OnTimerIrq(uint32_t active_channel);
 
 /**
  * @brief  모터 동작 상태 확인
  * @retval true  : 회전 진행 중
  * @retval false : 정지 상태
  */
-bool Stepper_IsBusy(void);
+bool Stepper_IsBusy(stepper_t *m);
+
+/**
+ * @brief  현재 스텝 속도(sps, 현재 구동 모드 스텝 기준), 정지 중이면 0
+ *
+ * 다음 스텝까지 예약된 간격으로 계산한 근사값 (가감속/EMG 감속 반영).
+ */
+uint16_t Stepper_GetSpeed(stepper_t *m);
+
+/**
+ * @brief  phase 출력 비용 측정 (정지 상태에서만, DWT 사이클 카운터 사용)
+ *
+ * 측정 동안 인터럽트를 막으므로 main 루프에서 호출. 끝나면 전원 상태 출력(OFF/REDUCED) 복원.
+ * @param  n          : 반복 횟수
+ * @param  halCycles  : 기존 HAL_GPIO_WritePin x4 방식 총 사이클
+ * @param  bsrrCycles : BSRR 워드 방식 총 사이클
+ * @retval false : 회전 중이라 측정하지 않음
+ */
+bool Stepper_BenchPhaseOutput(stepper_t *m, uint32_t n, uint32_t *halCycles, uint32_t *bsrrCycles);
 
 
 #endif /* INC_STEPPER_H_ */
@@ -34,6 +34,12 @@ extern "C" {
 
 extern TIM_HandleTypeDef htim1;
 
+extern TIM_HandleTypeDef htim3;
+
+extern TIM_HandleTypeDef htim4;
+
+extern TIM_HandleTypeDef htim5;
+
 extern TIM_HandleTypeDef htim11;
 
 /* USER CODE BEGIN Private defines */
@@ -41,6 +47,9 @@ extern TIM_HandleTypeDef htim11;
 /* USER CODE END Private defines */
 
 void MX_TIM1_Init(void);
+void MX_TIM3_Init(void);
+void MX_TIM4_Init(void);
+void MX_TIM5_Init(void);
 void MX_TIM11_Init(void);
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
@@ -12,6 +12,9 @@
 #include "stepper.h"
 #include "led.h"
 #include "photo.h"
+#include "beam.h"
+#include "shaft.h"
+#include "param.h"
 
 #include "logger.h"
 #include "usart.h"
@@ -19,6 +22,15 @@
 #include "resident_uart.h"
 
 
+/* 카(1번) 모터: IN1~IN4 + TIM4 CH1(DMA 가능) */
+static const stepper_hw_t s_carMotorHw =
+{
+  .port    = { IN1_PORT, IN2_PORT, IN3_PORT, IN4_PORT },
+  .pin     = { IN1_PIN,  IN2_PIN,  IN3_PIN,  IN4_PIN  },
+  .channel = TIM_CHANNEL_1,
+};
+
+
 //static void Debug_PrintPhotoPeriodic(void)
 //{
 //  static uint32_t last = 0;
@@ -29,7 +41,7 @@
 //  Photo_GetRaw(&p1,&p2,&p3);
 //
 //  photo_fsm_t f = Photo_GetFSM();
-//  Log_Printf("RAW=%u%u%u %s\r\n", p1,p2,p3, Photo_FSM_ToString(f));
+//  Log_Printf("RAW=%u%u%u %s\r\n", p1,p2,p3, FloorFSM_ToString(f));
 //}
 
 void App_Init(void)
@@ -40,32 +52,39 @@ void App_Init(void)
   ButtonInit();
   LED_Init();
   Servo_Init();
-  Stepper_Init();
+  Stepper_Init(&hstepper1, &s_carMotorHw);
   Photo_Init();
+  Beam_Init();
+  Param_Init();
+  Shaft_Init();
   Elevator_Init();
 
+  /* 첫 부팅(저장된 shaft map 없음): 자동으로 승강로 학습 주행 */
+  if (!Shaft_GetMap()->valid) Elevator_RequestCalibration();
+
   Log_Init(&huart2);
   ResidentUART_Init(&huart2);
 }
 
 void App_Task(void)
 {
-  displayScan();
-
   /* 센서/상태 갱신 */
   if (Photo_Task())
   {
     // 변화 있었을 때만 찍고 싶으면 여기서 찍어도 됨
+    Shaft_OnPhotoEdge(Photo_GetFSM());   // 구간 스텝 수 학습/검사
   }
+  Shaft_Task();                          // 이동 중 탈조(STALL) 감시
+  Beam_Task();                           // 도어 존 빔 센서
 //  Debug_PrintPhotoPeriodic();
 
   /* 입력/정책/상태머신 */
   Elevator_InputTask();
   Elevator_Task();
 
-  /* 구동부 */
-  Stepper_Task();
+  /* 구동부 (스텝모터는 TIM4 ISR에서 구동, 여기서는 정지 중 코일 전원만 관리) */
   Servo_Run();
+  Stepper_Task(&hstepper1);
 
   /* FND */
   uint8_t doorOpen = Servo_IsOpened() ? 1 : 0;
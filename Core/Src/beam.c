@@ -0,0 +1,111 @@
+/*
+ * beam.c
+ *
+ *  - 도어 존 빔 센서 입력(PB8, EXTI9_5)
+ *  - 빔이 끊기면 LOW(RESET)인 센서 기준 (photo.c와 같은 모듈)
+ *  - EXTI 발생 시 pending 플래그만 세우고, 실제 판독은 Task에서 디바운스 후 수행
+ *  - EXTI 놓침 대비 폴링도 함께 수행
+ */
+
+
+#include "beam.h"
+
+
+/* ==============================
+ *         핀 매핑
+ * ============================== */
+#define BEAM_PORT GPIOB
+#define BEAM_PIN  GPIO_PIN_8
+
+/* 빔 끊기면 LOW */
+#define BEAM_ACTIVE_STATE GPIO_PIN_RESET
+
+/* 사람이 지나가는 동안 짧게 튀는 것만 거름 (닫히는 중 되열기가 늦지 않게 짧게) */
+#define BEAM_DEBOUNCE_MS  10
+#define BEAM_POLL_MS      20
+
+/* 센서가 없는 보드도 PB8 풀업이 '빔 통과'로 읽히므로 기본은 꺼짐(UART BEAM ON으로 켬).
+ * 센서를 단 보드는 빌드 옵션 -DBEAM_ENABLE_DEFAULT=true로 기본값을 바꿀 수 있다. */
+#ifndef BEAM_ENABLE_DEFAULT
+#define BEAM_ENABLE_DEFAULT  false
+#endif
+
+
+/* ==============================
+ *        내부 상태 변수
+ * ============================== */
+static volatile uint8_t    s_irqPending = 0;
+static volatile uint32_t   s_irqTick = 0;
+#ifdef BEAM_SIM
+static volatile beam_sim_t s_sim = BEAM_SIM_OFF;
+#endif
+static volatile bool       s_enabled = BEAM_ENABLE_DEFAULT;
+
+static uint8_t  s_blocked = 0;     // 마지막으로 확정된 값
+static uint32_t s_pollTick = 0;
+
+
+/* 현재 입력(BEAM_SIM 빌드에서는 시뮬레이션 우선) */
+static uint8_t ReadNow(void)
+{
+#ifdef BEAM_SIM
+  if (s_sim == BEAM_SIM_CLEAR)   return 0;
+  if (s_sim == BEAM_SIM_BLOCKED) return 1;
+#endif
+  return (HAL_GPIO_ReadPin(BEAM_PORT, BEAM_PIN) == BEAM_ACTIVE_STATE) ? 1 : 0;
+}
+
+
+void Beam_Init(void)
+{
+  s_irqPending = 0;
+  s_irqTick = 0;
+  s_pollTick = HAL_GetTick();
+  s_blocked = ReadNow();
+}
+
+/* EXTI 콜백에서 호출: 실제 읽기는 Task에서 디바운스 후 처리 */
+void Beam_OnExti(uint16_t GPIO_Pin)
+{
+  if (GPIO_Pin != BEAM_PIN) return;
+  s_irqPending = 1;
+  s_irqTick = HAL_GetTick();
+}
+
+/* 변경이 있으면 1 반환 */
+uint8_t Beam_Task(void)
+{
+  uint32_t now = HAL_GetTick();
+  bool read = false;
+
+  /* 1) EXTI 기반 갱신 (디바운스 대기) */
+  if (s_irqPending && now - s_irqTick >= BEAM_DEBOUNCE_MS)
+  {
+    s_irqPending = 0;
+    read = true;
+  }
+
+  /* 2) 백업 폴링(EXTI miss / 시뮬레이션 전환 반영) */
+  if (now - s_pollTick >= BEAM_POLL_MS)
+  {
+    s_pollTick = now;
+    if (!s_irqPending) read = true;
+  }
+
+  if (!read) return 0;
+
+  uint8_t n = ReadNow();
+  if (n == s_blocked) return 0;
+  s_blocked = n;
+  return 1;
+}
+
+bool Beam_IsBlocked(void) { return s_enabled && s_blocked; }
+
+void Beam_SetEnabled(bool en) { s_enabled = en; }
+bool Beam_IsEnabled(void) { return s_enabled; }
+
+#ifdef BEAM_SIM
+void Beam_SetSim(beam_sim_t sim) { s_sim = sim; }
+beam_sim_t Beam_GetSim(void) { return s_sim; }
+#endif
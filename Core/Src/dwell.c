@@ -0,0 +1,135 @@
+/*
+ * dwell.c
+ *
+ *  - 문 열림 대기(dwell) 시간 결정 (기준 시간, 단축, 연장, 빔 대기, CLOSE 잠금)
+ *  - 시각과 센서 값은 모두 호출자가 넘긴다 (HAL_GetTick/Beam_* 를 직접 읽지 않음)
+ *  - 모든 함수는 main 컨텍스트에서 호출
+ */
+
+
+#include "dwell.h"
+#include <string.h>
+
+
+/* ==============================
+ *        내부 상태 변수
+ * ============================== */
+static uint32_t s_doorTick;          // 문이 다 열린 시각
+static uint32_t s_dwellMs;           // 현재 닫기 시점(s_doorTick 기준)
+static bool     s_hall;              // 이번 정지의 기준(Dwell_Begin에서 고정)
+static bool     s_windowDone;        // 단축 판정 창이 지났는지
+static bool     s_short;
+static bool     s_extended;
+static bool     s_beam;              // 대기 중 빔이 끊겨 있었는지
+static uint8_t  s_calls;             // 문 열린 뒤 들어온 카 호출 수
+static uint8_t  s_seq;
+static dwell_stats_t s_stats;
+
+
+void Dwell_Init(void)
+{
+  s_doorTick = 0;
+  s_dwellMs = 0;
+  s_hall = false;
+  s_calls = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+void Dwell_Begin(uint32_t now, bool hall, bool beamEnabled, uint8_t callSeq)
+{
+  s_doorTick = now;
+  s_hall = hall;
+  if (beamEnabled) s_dwellMs = hall ? DWELL_BEAM_HALL_MS : DWELL_BEAM_CAR_MS;
+  else             s_dwellMs = hall ? DWELL_HALL_MS : DWELL_CAR_MS;
+  s_beam = false;
+  s_windowDone = false;
+  s_short = false;
+  s_extended = false;
+  s_calls = 0;
+  s_seq = callSeq;
+}
+
+void Dwell_Extend(uint32_t now)
+{
+  uint32_t t = (now - s_doorTick) + DWELL_EXTEND_MS;
+  if (t > DWELL_MAX_MS) t = DWELL_MAX_MS;
+  if (t > s_dwellMs)
+  {
+    s_dwellMs = t;
+    s_extended = true;
+  }
+}
+
+bool Dwell_Task(uint32_t now, bool beamBlocked, uint8_t callSeq)
+{
+  if (callSeq != s_seq)
+  {
+    s_calls += (uint8_t)(callSeq - s_seq);
+    s_seq = callSeq;
+    Dwell_Extend(now);
+  }
+
+  uint32_t elapsed = now - s_doorTick;
+
+  /* 문 사이에 사람/물건: 닫지 않고, 풀리면 짧은 타이머부터 다시 */
+  if (beamBlocked)
+  {
+    s_beam = true;
+    return false;
+  }
+  if (s_beam)
+  {
+    s_beam = false;
+    s_dwellMs = elapsed + DWELL_BEAM_CLEAR_MS;
+    s_windowDone = true;   // 누가 지나갔음: 이후 단축 판정으로 이 타이머를 덮지 않음
+    s_stats.beamCross++;
+  }
+
+  if (!s_windowDone && elapsed >= DWELL_WINDOW_MS)
+  {
+    s_windowDone = true;
+    uint32_t idle = s_hall ? DWELL_HALL_IDLE_MS : DWELL_CAR_IDLE_MS;
+    if (s_calls == 0 && !s_extended && idle < s_dwellMs)
+    {
+      s_dwellMs = idle;
+      s_short = true;
+    }
+  }
+
+  return elapsed >= s_dwellMs;
+}
+
+uint32_t Dwell_End(uint32_t now, bool closeBtn)
+{
+  dwell_stats_t *st = &s_stats;
+  uint32_t ms = now - s_doorTick;
+
+  if (st->count == 0 || ms < st->minMs) st->minMs = ms;
+  if (ms > st->maxMs) st->maxMs = ms;
+  st->count++;
+  st->totalMs += ms;
+  if (s_hall)          st->hallStops++;
+  if (closeBtn)        st->closeBtn++;
+  else if (s_short)    st->shortened++;
+  else if (s_extended) st->extended++;
+  return ms;
+}
+
+bool Dwell_CanClose(bool beamBlocked) { return !beamBlocked; }
+
+bool Dwell_ShouldReopen(bool beamBlocked)
+{
+  if (!beamBlocked) return false;
+  s_stats.beamReopen++;
+  return true;
+}
+
+bool Dwell_IsHall(void) { return s_hall; }
+uint8_t Dwell_GetCalls(void) { return s_calls; }
+
+void Dwell_GetStats(dwell_stats_t *out)
+{
+  if (out) *out = s_stats;
+}
+
+void Dwell_ResetStats(void) { memset(&s_stats, 0, sizeof(s_stats)); }
@@ -14,17 +14,90 @@
 #include "servo.h"
 #include "led.h"
 #include "photo.h"
+#include "shaft.h"
+#include "beam.h"
+#include "dwell.h"
+#include "param.h"
 #include "logger.h"
+#include <string.h>
 
-#define DOOR_WAIT_MS_DEFAULT  6000
 #define MOVE_TIMEOUT_MS       20000   // 안전 타임아웃(센서/기구 문제 대비)
+#define STALL_RETRY_MAX       1       // 탈조 감지 시 저속 재시도 횟수
+#define ARRIVE_CREEP_STEPS    64      // 층 센서 경계 앞에서 감속을 끝내고 저속으로 접근할 거리(half-step)
+#define LEVEL_DEFAULT_STEPS   40      // shaft map이 없을 때 센서 감지 후 더 들어갈 거리(half-step)
+#define LEVEL_SETTLE_MS       60      // 정지 후 포토 판독(디바운스/폴링) 대기
+#define LEVEL_RETRY_MAX       2       // 센서 창을 벗어났을 때 되돌아오는 보정 횟수
+#define EMG_STOP_MAX_STEPS    STEPPER_EMG_MAX_STEPS   // EMG 감속 최대 정지 거리(half-step)
+#define ADVANCE_OPEN_STEPS_DEFAULT 32 // 레벨링 중 도어 존 + 중앙까지 이 거리(half-step) 이하면 문 미리 열기(0=끔)
+
+/* 방향별 CRUISE 자동 조정
+ * - 샤프트 이상 없이 도착할 때마다 TUNE_STEP_SPS씩 올림(TUNE_CRUISE_MAX까지)
+ * - STALL 감지 시 TUNE_BACKOFF_PCT 만큼 내림(START 속도까지)
+ * - 저장값과 TUNE_SAVE_DELTA 이상 차이 나거나 내렸을 때, 주차 중에 FLASH 저장
+ */
+#define TUNE_STEP_SPS         20
+#define TUNE_BACKOFF_PCT      15
+#define TUNE_CRUISE_MAX       1400
+#define TUNE_SAVE_DELTA       100
+
+
+/* 이 엘리베이터(카)를 구동하는 모터 */
+static stepper_t *const s_motor = &hstepper1;
 
 static ELEVATOR_STATE s_state;
 static uint8_t s_curFloor;     // 마지막 확정층(1~3)
 static uint8_t s_targetFloor;  // 목표층(1~3)
-static uint32_t s_doorTick;
 static uint32_t s_moveStartTick;
 
+/* 탈조 재시도 상태: 재시도 중에는 CRUISE를 START 속도로 낮춰서 이동 */
+static uint8_t  s_stallRetry;
+static bool     s_slowRetry;
+static uint16_t s_saveStart, s_saveCruise, s_saveAccel;
+
+/* 캘리브레이션 주행 단계 */
+typedef enum
+{
+  CAL_SEEK_F1,   // 1층 구간까지 하강
+  CAL_UP,        // 원점(0)에서 3층까지 상승하며 경계 기록
+  CAL_DOWN       // 3층에서 1층까지 하강하며 경계 기록
+} cal_phase_t;
+
+static cal_phase_t   s_calPhase;
+static volatile bool s_calRequest;
+static bool          s_calBrake;     // 구간 끝 감속 정지 중(멈추면 다음 단계)
+
+/* 레벨링(도착 후 센서 창 중앙 맞춤) 상태 */
+static bool     s_leveling;
+static bool     s_levelCorrecting;   // 창을 벗어나 센서까지 되돌아가는 중
+static uint8_t  s_levelTries;
+static uint8_t  s_levelDir;          // 도착 시 진행 방향
+static uint8_t  s_levelCorrDir;      // 되돌아가는 방향
+static bool     s_levelBrake;        // 감속 정지 후 중앙 맞춤 계획 대기
+static int32_t  s_levelEntry;        // map이 없을 때의 정지 목표(창 진입점 + LEVEL_DEFAULT_STEPS)
+static uint32_t s_levelTick;         // 모터 정지 시각(0=아직 회전 중)
+
+static volatile bool s_emgReport;        // EMG 감속 완료 후 정지 거리 출력 + 이동 상태 정리 대기
+
+static volatile uint16_t s_advOpenSteps = ADVANCE_OPEN_STEPS_DEFAULT;
+static bool     s_advOpen;           // 레벨링 중 문을 미리 열기 시작했는지
+
+/* 방향별 CRUISE 학습 상태 ([0]=UP, [1]=DOWN) */
+static uint16_t s_tuneCruise[2];
+static uint16_t s_tuneSaved[2];
+static bool     s_tuneDirty;
+static bool     s_tripClean;         // 이번 이동에서 샤프트 이상이 없었는지
+static uint8_t  s_moveDir;
+
+/* 문 열림 대기 입력 (시간 결정은 dwell.c) */
+static bool     s_dwellHall;         // 이번 정지에서 홀 호출을 처리했는지 (DwellBegin에서 넘김)
+static volatile uint8_t s_carCallSeq;   // 카 호출 등록마다 +1 (main/UART ISR 모두에서 증가, IRQ 마스크)
+static volatile bool s_dwellStatsReset;
+
+/* UART에서 받은 스텝모터 설정 변경 (ISR에서 바로 바꾸면 이동 시작과 경쟁하므로 IDLE에서 적용) */
+static volatile int8_t s_driveRequest = -1;   // stepper_drive_t, -1=없음
+static volatile int8_t s_profileRequest = -1; // stepper_profile_t, -1=없음
+static volatile int8_t s_dmaRequest = -1;     // 0=OFF, 1=ON, -1=없음
+
 static bool car_call[4];
 static bool hall_up[4];
 static bool hall_down[4];
@@ -50,13 +123,20 @@ static bool ShouldStopHere(uint8_t floor, ELEVATOR_STATE movingState)
   return (hall_up[floor] || hall_down[floor]);
 }
 
-static void ConsumeStopRequests(uint8_t floor)
+static void ClearStopRequests(uint8_t floor)
 {
   car_call[floor]=false;
   hall_up[floor]=false;
   hall_down[floor]=false;
 }
 
+/* 문을 열기 전(DwellBegin 전)의 요청 소비: 홀 호출이면 대기 시간 기준을 홀 쪽으로 */
+static void ConsumeStopRequests(uint8_t floor)
+{
+  if (hall_up[floor] || hall_down[floor]) s_dwellHall = true;   // 대기 시간 정책용
+  ClearStopRequests(floor);
+}
+
 /* ✅ 다음 목적지 선택 (방향락 + 반대방향은 보류) */
 static bool PickNextTarget(ELEVATOR_STATE moveDir, uint8_t *outTarget)
 {
@@ -90,48 +170,598 @@ static bool PickNextTarget(ELEVATOR_STATE moveDir, uint8_t *outTarget)
   return false;
 }
 
+/* ✅ 도착 계획: shaft map으로 목표층 센서 경계까지 남은 거리를 계산해
+ *    경계 ARRIVE_CREEP_STEPS 앞에서 감속이 끝나도록 이동, 이후 START 속도로 센서까지 크립.
+ *    map/위치 기준이 없으면 false (기존 방식: 연속 회전 후 센서에서 정지)
+ */
+static bool PlanArrival(uint8_t target, uint8_t dir)
+{
+  const shaft_map_t *m = Shaft_GetMap();
+  if (!m->valid || !Shaft_IsReferenced()) return false;
+
+  /* 위로 가면 목표층 구간의 아래 경계, 아래로 가면 위 경계에서 센서가 잡힘 */
+  int32_t edge = (dir == DIR_UP) ? m->lo[0][target] : m->hi[1][target];
+  if (edge == SHAFT_POS_NONE) return false;
+
+  int32_t approach = (dir == DIR_UP) ? (edge - ARRIVE_CREEP_STEPS) : (edge + ARRIVE_CREEP_STEPS);
+  return Stepper_MoveToCreep(s_motor, approach, dir);
+}
+
 static void StartMoveTo(uint8_t target)
 {
   if (target == s_curFloor) return;
 
+  /* 인터록: 문이 완전히 닫히기 전에는 출발하지 않음(호출한 상태에서 다음 루프에 재시도) */
+  if (!Servo_IsClosed())
+  {
+    Servo_Close();
+    return;
+  }
+
   s_targetFloor = target;
   s_moveStartTick = HAL_GetTick();
 
   uint8_t dir = (target > s_curFloor) ? DIR_UP : DIR_DOWN;
-  Stepper_StartContinuous(dir);
+  s_moveDir = dir;
+  s_tripClean = !s_slowRetry;   // 저속 재시도/캘리브레이션 이동은 학습에 쓰지 않음
+
+  bool planned = PlanArrival(target, dir);
+  if (!planned) Stepper_StartContinuous(s_motor, dir);
+  Shaft_OnMoveStart(dir);
 
   s_state = (dir == DIR_UP) ? ELEVATOR_MOVING_UP : ELEVATOR_MOVING_DOWN;
 
-  Log_Printf("MOVE START: cur=%u target=%u dir=%s\r\n",
-             s_curFloor, s_targetFloor, (dir==DIR_UP)?"UP":"DOWN");
+  Log_Printf("MOVE START: cur=%u target=%u dir=%s%s\r\n",
+             s_curFloor, s_targetFloor, (dir==DIR_UP)?"UP":"DOWN", planned ? " (PLANNED)" : "");
+}
+
+/* ==============================
+ *    방향별 CRUISE 자동 조정
+ * ============================== */
+static inline uint8_t TuneIndex(uint8_t dir) { return (dir == DIR_UP) ? 0 : 1; }
+
+/* 학습값을 스텝모터에 적용 (정지 상태에서 호출) */
+static void ApplyTune(void)
+{
+  Stepper_SetDirCruise(s_motor, DIR_UP,   s_tuneCruise[0]);
+  Stepper_SetDirCruise(s_motor, DIR_DOWN, s_tuneCruise[1]);
+}
+
+static void TuneRaise(uint8_t dir)
+{
+  uint8_t i = TuneIndex(dir);
+  if (s_tuneCruise[i] >= TUNE_CRUISE_MAX) return;
+
+  uint32_t v = (uint32_t)s_tuneCruise[i] + TUNE_STEP_SPS;
+  s_tuneCruise[i] = (uint16_t)((v > TUNE_CRUISE_MAX) ? TUNE_CRUISE_MAX : v);
+
+  int32_t diff = (int32_t)s_tuneCruise[i] - (int32_t)s_tuneSaved[i];
+  if (diff >= TUNE_SAVE_DELTA || diff <= -TUNE_SAVE_DELTA) s_tuneDirty = true;
+}
+
+static void TuneBackoff(uint8_t dir)
+{
+  uint8_t i = TuneIndex(dir);
+  uint16_t start;
+  Stepper_GetProfile(s_motor, &start, NULL, NULL);
+
+  uint32_t v = (uint32_t)s_tuneCruise[i] * (100 - TUNE_BACKOFF_PCT) / 100;
+  s_tuneCruise[i] = (uint16_t)((v < start) ? start : v);
+  s_tuneDirty = true;
+
+  Log_Printf("TUNE: %s CRUISE -> %u sps\r\n", (dir == DIR_UP) ? "UP" : "DOWN", s_tuneCruise[i]);
+}
+
+/* 주차 중 저장: FLASH 지우기가 1~2초 CPU를 멈추므로 모터 정지 + 문 닫힘에서만 */
+static void TuneSaveIfNeeded(void)
+{
+  if (!s_tuneDirty || Stepper_IsBusy(s_motor) || !Servo_IsClosed()) return;
+
+  param_t *p = Param_Get();
+  p->cruiseSps[0] = s_tuneCruise[0];
+  p->cruiseSps[1] = s_tuneCruise[1];
+
+  if (Param_Save())
+  {
+    s_tuneSaved[0] = s_tuneCruise[0];
+    s_tuneSaved[1] = s_tuneCruise[1];
+    Log_Printf("TUNE SAVED: UP=%u DOWN=%u\r\n", s_tuneCruise[0], s_tuneCruise[1]);
+  }
+  s_tuneDirty = false;
+}
+
+static void TuneInit(void)
+{
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    uint16_t v = Param_IsValid() ? Param_Get()->cruiseSps[i] : 0;
+    s_tuneSaved[i]  = v;
+    s_tuneCruise[i] = v ? v : STEPPER_CRUISE_SPS_DEFAULT;
+  }
+  s_tuneDirty = false;
+  s_tripClean = false;
+  s_moveDir = DIR_UP;
+  ApplyTune();
+}
+
+
+/* ✅ 이동 종료(도착/타임아웃/포기/EMG 정지 완료): 모터 정지 + 레벨링/캘리브레이션/저속 재시도 해제
+ *    정상 도착은 레벨링/캘리브레이션이 감속 정지를 끝낸 뒤라 이미 멈춰 있고,
+ *    회전 중에 여기로 오는 것은 타임아웃/STALL/캘리브레이션 실패뿐이다(즉시 정지). */
+static void FinishMove(void)
+{
+  Stepper_Stop(s_motor);
+  s_stallRetry = 0;
+  s_leveling = false;
+  s_levelBrake = false;
+  s_levelCorrecting = false;
+  s_calBrake = false;
+
+  if (s_slowRetry)
+  {
+    Stepper_SetProfile(s_motor, s_saveStart, s_saveCruise, s_saveAccel);
+    s_slowRetry = false;
+  }
+  ApplyTune();   // 방향별 학습 CRUISE 복원/갱신
+}
+
+/* ✅ 저속 이동: 현재 프로파일을 저장하고 CRUISE를 START 속도로 낮춤 (FinishMove에서 복원) */
+static void UseSlowProfile(void)
+{
+  if (!s_slowRetry)
+  {
+    Stepper_GetProfile(s_motor, &s_saveStart, &s_saveCruise, &s_saveAccel);
+    s_slowRetry = true;
+  }
+  Stepper_SetProfile(s_motor, s_saveStart, s_saveStart, s_saveAccel);
+  Stepper_SetDirCruise(s_motor, DIR_UP,   s_saveStart);   // 방향별 학습값도 잠시 START로
+  Stepper_SetDirCruise(s_motor, DIR_DOWN, s_saveStart);
+}
+
+/* 문 미리 열기 인터록 (아래 "문 미리 열기"에 정의) */
+static void AbortAdvanceOpen(const char *why);
+/* 레벨링 중앙 맞춤 (아래 "레벨링"에 정의) */
+static void LevelToCenter(void);
+
+/* ✅ 이동 중 샤프트 감시 결과 처리: 상태가 바뀌었으면 true */
+static bool HandleShaftFault(void)
+{
+  shaft_fault_t f = Shaft_GetFault();
+  if (f == SHAFT_FAULT_NONE) return false;
+
+  if (f == SHAFT_FAULT_EARLY)
+  {
+    /* 포토 변화가 너무 이름: 기록만 하고 계속 이동 */
+    Log_Printf("SHAFT: EARLY EDGE\r\n");
+    Shaft_ClearFault();
+    s_tripClean = false;
+    return false;
+  }
+
+  /* STALL: 스텝은 나가는데 카가 다음 구간에 도달하지 못함 */
+  Stepper_Stop(s_motor);
+  AbortAdvanceOpen("STALL");
+  Shaft_ClearFault();
+  if (!s_slowRetry) TuneBackoff(s_moveDir);   // 이 방향 CRUISE를 낮춰 다음 이동부터 적용
+
+  if (s_stallRetry < STALL_RETRY_MAX)
+  {
+    s_stallRetry++;
+    /* 가속 없이 START(pull-in 이하) 속도로 토크 여유를 확보해 재시도 */
+    UseSlowProfile();
+    Log_Printf("SHAFT: STALL -> RETRY SLOW (%u/%u)\r\n", s_stallRetry, STALL_RETRY_MAX);
+
+    if (s_leveling)
+    {
+      /* 목표층 창은 이미 감지(cur == target): 이동을 다시 계획하지 않고 중앙 맞춤만 재시도 */
+      s_levelCorrecting = false;
+      s_levelBrake = false;
+      s_moveStartTick = HAL_GetTick();
+      LevelToCenter();
+    }
+    else
+    {
+      StartMoveTo(s_targetFloor);
+    }
+    return true;
+  }
+
+  /* 재시도도 실패: 기구 문제로 보고 EMG로 정지(RESUME 필요) */
+  FinishMove();
+  ledOff();
+  s_state = ELEVATOR_EMG;
+  Log_Printf("SHAFT: STALL -> EMG\r\n");
+  return true;
+}
+
+/* ==============================
+ *      캘리브레이션 주행
+ * ==============================
+ * 1) 1층 구간까지 하강(이미 1층이면 생략) 후 정지, 그 위치를 원점(0)으로
+ * 2) 3층 구간에 들어갈 때까지 상승 -> 위 방향 경계 기록
+ * 3) 1층 구간에 들어갈 때까지 하강 -> 아래 방향 경계 기록
+ * 모두 START 속도 등속(저속)으로 주행하고, 경계 기록은 shaft 모듈이 담당.
+ * 구간마다 MOVE_TIMEOUT_MS 안에 끝나지 않으면 실패 처리(기존 map 유지).
+ */
+static void CalMove(cal_phase_t phase, uint8_t dir)
+{
+  s_calPhase = phase;
+  s_moveStartTick = HAL_GetTick();
+  Stepper_StartContinuous(s_motor, dir);
+  Shaft_OnMoveStart(dir);
+}
+
+static void StartCalibration(void)
+{
+  UseSlowProfile();
+  s_state = ELEVATOR_CALIBRATING;
+  s_calBrake = false;
+  Log_Printf("CALIBRATION START\r\n");
+
+  if (Photo_GetFSM() == PF_F1)
+  {
+    Stepper_SetPosition(s_motor, 0);
+    Shaft_CalBegin();
+    CalMove(CAL_UP, DIR_UP);
+  }
+  else
+  {
+    CalMove(CAL_SEEK_F1, DIR_DOWN);
+  }
+}
+
+static void FinishCalibration(bool ok)
+{
+  FinishMove();
+  ledOff();
+
+  /* map 검증 + FLASH 저장(모터 정지 후) */
+  bool saved = Shaft_CalEnd(ok);
+  s_state = ELEVATOR_IDLE;
+
+  Log_Printf("CALIBRATION %s\r\n", saved ? "DONE" : "FAIL");
+}
+
+static void CalibrationTask(void)
+{
+  photo_fsm_t f = Photo_GetFSM();
+
+  if (Shaft_GetFault() == SHAFT_FAULT_STALL ||
+      HAL_GetTick() - s_moveStartTick > MOVE_TIMEOUT_MS)
+  {
+    Shaft_ClearFault();
+    FinishCalibration(false);
+    return;
+  }
+
+  /* 구간 끝: 감속 정지가 끝난 뒤 다음 단계로 */
+  if (s_calBrake)
+  {
+    if (Stepper_IsBusy(s_motor)) return;
+    s_calBrake = false;
+
+    switch (s_calPhase)
+    {
+      case CAL_SEEK_F1:
+        Stepper_SetPosition(s_motor, 0);
+        Shaft_CalBegin();
+        CalMove(CAL_UP, DIR_UP);
+        break;
+
+      case CAL_UP:
+        s_curFloor = 3;
+        CalMove(CAL_DOWN, DIR_DOWN);
+        break;
+
+      case CAL_DOWN:
+        s_curFloor = 1;
+        FinishCalibration(true);
+        break;
+    }
+    return;
+  }
+
+  switch (s_calPhase)
+  {
+    case CAL_SEEK_F1:
+      ledDown();
+      if (f == PF_F1) { Stepper_Decelerate(s_motor); s_calBrake = true; }
+      break;
+
+    case CAL_UP:
+      ledUp();
+      if (f == PF_F3) { Stepper_Decelerate(s_motor); s_calBrake = true; }
+      break;
+
+    case CAL_DOWN:
+      ledDown();
+      if (f == PF_F1) { Stepper_Decelerate(s_motor); s_calBrake = true; }
+      break;
+  }
+}
+
+void Elevator_RequestCalibration(void)
+{
+  s_calRequest = true;
+}
+
+bool Elevator_RequestDriveMode(stepper_drive_t mode)
+{
+  if (mode > STEPPER_DRIVE_WAVE) return false;
+  s_driveRequest = (int8_t)mode;
+  return true;
+}
+
+bool Elevator_RequestProfileMode(stepper_profile_t mode)
+{
+  if (mode > STEPPER_PROFILE_SCURVE) return false;
+  s_profileRequest = (int8_t)mode;
+  return true;
+}
+
+void Elevator_RequestStepDma(bool enable)
+{
+  s_dmaRequest = enable ? 1 : 0;
+}
+
+/* 대기 중인 스텝모터 설정 변경 적용 (IDLE, 모터 정지 상태에서만 호출) */
+static void ApplyStepperRequests(void)
+{
+  static const char *const driveName[] = { "HALF", "FULL", "WAVE" };
+  static const char *const profileName[] = { "CONST", "TRAP", "SCURVE" };
+
+  if (Stepper_IsBusy(s_motor)) return;
+
+  int8_t drive = s_driveRequest;
+  if (drive >= 0)
+  {
+    s_driveRequest = -1;
+    if (Stepper_SetDriveMode(s_motor, (stepper_drive_t)drive))
+      Log_Printf("DRIVE %s\r\n", driveName[drive]);
+  }
+
+  int8_t profile = s_profileRequest;
+  if (profile >= 0)
+  {
+    s_profileRequest = -1;
+    if (Stepper_SetProfileMode(s_motor, (stepper_profile_t)profile))
+      Log_Printf("PROFILE %s\r\n", profileName[profile]);
+  }
+
+  int8_t dma = s_dmaRequest;
+  if (dma >= 0)
+  {
+    s_dmaRequest = -1;
+    if (Stepper_SetDmaMode(s_motor, dma != 0)) Log_Printf("STEPDMA %s\r\n", dma ? "ON" : "OFF");
+    else                                       Log_Printf("ERR: STEPDMA (no DMA stream)\r\n");
+  }
 }
 
 /* ✅ 포토로 현재층 갱신: 확정층(PF_Fx)일 때만 */
 static void UpdateFloorFromPhoto(void)
 {
-  photo_fsm_t f = Photo_GetFSM();
-  if (f == PF_F1) s_curFloor = 1;
-  else if (f == PF_F2) s_curFloor = 2;
-  else if (f == PF_F3) s_curFloor = 3;
+  uint8_t f = FloorFSM_FloorOf(Photo_GetFSM());
+  if (f) s_curFloor = f;
 }
 
 /* ✅ 목표층 도착 여부 */
 static bool ReachedTarget(void)
 {
-  photo_fsm_t f = Photo_GetFSM();
-  if (s_targetFloor == 1 && f == PF_F1) return true;
-  if (s_targetFloor == 2 && f == PF_F2) return true;
-  if (s_targetFloor == 3 && f == PF_F3) return true;
+  return FloorFSM_FloorOf(Photo_GetFSM()) == s_targetFloor;
+}
+
+/* ==============================
+ *      레벨링(센서 창 중앙 맞춤)
+ * ==============================
+ * 센서 첫 경계에서 멈추면 작은 오버런에도 PF_Fx가 풀려 재출발이 생기므로,
+ * 목표층을 감지하면 창 중앙(shaft map)까지 더 이동한 뒤 정지한다.
+ * - 센서를 감지했을 때 회전 중이면(등속/크립) 먼저 감속 정지하고, 멈춘 뒤 중앙까지 이동
+ * - map이 없으면 창에 들어온 지점에서 진행 방향으로 LEVEL_DEFAULT_STEPS 들어간 곳이 목표
+ * - 정지 후 창을 벗어나 있으면 센서까지 START 속도로 되돌아와서 다시 중앙 맞춤
+ */
+static void LevelToCenter(void)
+{
+  int32_t center;
+
+  s_levelTick = 0;
+  if (Shaft_IsReferenced() && Shaft_GetFloorCenter(s_targetFloor, &center))
+    Stepper_MoveTo(s_motor, center);
+  else
+    Stepper_MoveTo(s_motor, s_levelEntry);   // 감속하며 지나쳤으면 되돌아옴
+}
+
+/* 센서 창에 들어온 지점 기록 (map이 없을 때의 목표) */
+static void MarkLevelEntry(uint8_t dir)
+{
+  int32_t pos = Stepper_GetPosition(s_motor);
+  s_levelEntry = (dir == DIR_UP) ? (pos + LEVEL_DEFAULT_STEPS) : (pos - LEVEL_DEFAULT_STEPS);
+}
+
+/* 회전 중이면 감속 정지부터, 멈춘 뒤 LevelTask가 중앙 맞춤을 계획 */
+static void BrakeThenLevel(void)
+{
+  s_levelTick = 0;
+  if (Stepper_IsBusy(s_motor))
+  {
+    Stepper_Decelerate(s_motor);
+    s_levelBrake = true;
+  }
+  else
+  {
+    LevelToCenter();
+  }
+}
+
+static void StartLeveling(uint8_t dir)
+{
+  s_leveling = true;
+  s_levelCorrecting = false;
+  s_levelTries = 0;
+  s_levelDir = dir;
+  MarkLevelEntry(dir);
+  BrakeThenLevel();
+}
+
+/* 레벨링 완료(또는 포기) 시 true */
+static bool LevelTask(void)
+{
+  bool onFloor = ReachedTarget();
+
+  if (Stepper_IsBusy(s_motor))
+  {
+    /* 되돌아오는 중 센서 창에 다시 들어오면 그 자리에서 중앙 맞춤 */
+    if (s_levelCorrecting && onFloor)
+    {
+      s_levelCorrecting = false;
+      MarkLevelEntry(s_levelCorrDir);
+      BrakeThenLevel();
+    }
+    return false;
+  }
+
+  /* 감속 정지 완료: 이제 중앙까지 이동 */
+  if (s_levelBrake)
+  {
+    s_levelBrake = false;
+    LevelToCenter();
+    return false;
+  }
+
+  /* 정지 직후에는 포토 판독이 늦으므로 잠시 대기 */
+  if (s_levelTick == 0) { s_levelTick = HAL_GetTick(); return false; }
+  if (HAL_GetTick() - s_levelTick < LEVEL_SETTLE_MS) return false;
+
+  if (onFloor) return true;
+
+  if (s_levelTries >= LEVEL_RETRY_MAX)
+  {
+    Log_Printf("LEVEL FAIL @%u\r\n", s_targetFloor);
+    return true;
+  }
+  s_levelTries++;
+
+  /* 창 밖: 중앙을 알면 그쪽으로, 모르면 진행 반대 방향(오버런)으로 크립 */
+  int32_t center;
+  uint8_t dir = (s_levelDir == DIR_UP) ? DIR_DOWN : DIR_UP;
+  if (Shaft_IsReferenced() && Shaft_GetFloorCenter(s_targetFloor, &center))
+    dir = (Stepper_GetPosition(s_motor) < center) ? DIR_UP : DIR_DOWN;
+
+  Log_Printf("RELEVEL %u (%u/%u)\r\n", s_targetFloor, s_levelTries, LEVEL_RETRY_MAX);
+  s_levelCorrecting = true;
+  s_levelCorrDir = dir;
+  s_levelTick = 0;
+  Stepper_MoveToCreep(s_motor, Stepper_GetPosition(s_motor), dir);
   return false;
 }
 
+
+/* ==============================
+ *      문 미리 열기(advance opening)
+ * ==============================
+ * 레벨링 중 카가 목표층 센서 창(도어 존) 안에 있고 정지 목표(창 중앙)까지 남은 거리가
+ * s_advOpenSteps(half-step) 이하이면 마지막 레벨링 스텝이 끝나기 전에 문을 열기 시작한다.
+ * (정지할 층일 때만, 감속 정지 중에는 목표가 아직 정해지지 않았으므로 열지 않음)
+ * 거리는 드라이브 모드와 무관한 half-step 단위라 FULL/WAVE에서도 같은 기준이다.
+ * 인터록: 창을 벗어나면(재레벨링/오버런) 또는 STALL/타임아웃/EMG면
+ *         열던 위치에서 바로 닫힘으로 반전한다.
+ */
+static void AbortAdvanceOpen(const char *why)
+{
+  if (!s_advOpen) return;
+  s_advOpen = false;
+  Servo_Close();
+  Log_Printf("ADV OPEN ABORT: %s\r\n", why);
+}
+
+/* 이동 타임아웃: 정지 후 미리 열던 문이 있으면 DOOR_CLOSING에서 닫힘을 끝까지 확인 */
+static void MoveTimeout(void)
+{
+  AbortAdvanceOpen("TIMEOUT");
+  FinishMove();
+  ledOff();
+  s_state = Servo_IsClosed() ? ELEVATOR_IDLE : ELEVATOR_DOOR_CLOSING;
+  Log_Printf("MOVE TIMEOUT -> %s\r\n", (s_state == ELEVATOR_IDLE) ? "IDLE" : "DOOR CLOSE");
+}
+
+static void AdvanceOpenTask(ELEVATOR_STATE movingState)
+{
+  if (!s_leveling) return;
+
+  bool inZone = ReachedTarget() && !s_levelCorrecting;
+
+  if (s_advOpen)
+  {
+    if (!inZone) AbortAdvanceOpen("LEFT ZONE");
+    return;
+  }
+
+  uint16_t maxSteps = s_advOpenSteps;
+  if (maxSteps == 0 || !inZone || s_levelBrake) return;
+  if (!ShouldStopHere(s_targetFloor, movingState)) return;   // 서지 않을 층이면 열지 않음
+
+  /* LevelToCenter와 같은 목표: map이 있으면 창 중앙, 없으면 진입점 + LEVEL_DEFAULT_STEPS */
+  int32_t target;
+  if (!(Shaft_IsReferenced() && Shaft_GetFloorCenter(s_targetFloor, &target))) target = s_levelEntry;
+  int32_t remain = target - Stepper_GetPosition(s_motor);
+  if (remain < 0) remain = -remain;
+  if (remain > (int32_t)maxSteps) return;
+
+  s_advOpen = true;
+  Servo_Open();
+  Log_Printf("ADV OPEN @%u\r\n", s_targetFloor);
+}
+
+void Elevator_SetAdvanceOpenSteps(uint16_t steps) { s_advOpenSteps = steps; }
+uint16_t Elevator_GetAdvanceOpenSteps(void) { return s_advOpenSteps; }
+
+
+/* ==============================
+ *      문 열림 대기(dwell)
+ * ============================== */
+static void DwellBegin(void)
+{
+  Dwell_Begin(HAL_GetTick(), s_dwellHall, Beam_IsEnabled(), s_carCallSeq);
+}
+
+/* 탑승 활동 감지: 지금부터 DWELL_EXTEND_MS 뒤로 닫기 시점 미룸 */
+static void DwellExtend(void) { Dwell_Extend(HAL_GetTick()); }
+
+/* 닫을 시간이면 true */
+static bool DwellTask(void) { return Dwell_Task(HAL_GetTick(), Beam_IsBlocked(), s_carCallSeq); }
+
+/* 대기 종료 기록 (DOOR_WAIT -> DOOR_CLOSING 전이 시) */
+static void DwellEnd(bool closeBtn)
+{
+  uint32_t ms = Dwell_End(HAL_GetTick(), closeBtn);
+
+  Log_Printf("DWELL %lums %s CALLS=%u%s\r\n", (unsigned long)ms, Dwell_IsHall() ? "HALL" : "CAR",
+             Dwell_GetCalls(), closeBtn ? " (CLOSE BTN)" : "");
+  s_dwellHall = false;
+}
+
+void Elevator_GetDwellStats(elevator_dwell_stats_t *out) { Dwell_GetStats(out); }
+
+void Elevator_ResetDwellStats(void) { s_dwellStatsReset = true; }
+
+
 void Elevator_Init(void)
 {
   s_state = ELEVATOR_IDLE;
   s_curFloor = 1;      // 초기값(포토 PF_F1 들어오면 자동 보정)
   s_targetFloor = 1;
-  s_doorTick = 0;
   s_moveStartTick = 0;
+  s_stallRetry = 0;
+  s_slowRetry = false;
+  s_calPhase = CAL_SEEK_F1;
+  s_calRequest = false;
+  s_driveRequest = -1;
+  s_profileRequest = -1;
+  s_dmaRequest = -1;
+  s_leveling = false;
+  s_emgReport = false;
+  s_dwellHall = false;
+  Dwell_Init();
+  TuneInit();
   ClearAllRequests();
 }
 
@@ -139,6 +769,13 @@ void Elevator_RequestCar(uint8_t floor)
 {
   if (floor < 1 || floor > 3) return;
   car_call[floor] = true;
+
+  /* main(버튼)과 UART ISR 양쪽에서 불리므로 read-modify-write 중 끼어들지 않게 */
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  s_carCallSeq++;
+  __set_PRIMASK(primask);
+
   Log_Printf("CAR CALL: %u\r\n", floor);
 }
 
@@ -147,19 +784,31 @@ void Elevator_InputTask(void)
   if (Button_GetPressed(BTN_EMG))
   {
     s_state = ELEVATOR_EMG;
-    Stepper_Stop();
+    /* 즉시 코일 고정 대신 최대 감속으로 정지 (거리 제한), 완료는 Elevator_Task에서 보고 */
+    Stepper_EmergencyStop(s_motor, EMG_STOP_MAX_STEPS);
+    s_emgReport = true;
+    AbortAdvanceOpen("EMG");
+    Shaft_CalEnd(false);   // 캘리브레이션 중이었다면 기록 폐기
     ledOff();
     Log_Printf("EMG STOP\r\n");
     return;
   }
 
+  /* OPEN: 정지(IDLE)/열림 대기/닫히는 중에만 (이동/EMG/캘리브레이션 중 무시: 달리는 중 문 열림 방지) */
   if (Button_GetPressed(BTN_OPEN))
   {
-    if (s_state != ELEVATOR_EMG) s_state = ELEVATOR_DOOR_OPENING;
+    if (s_state == ELEVATOR_DOOR_WAIT) DwellExtend();   // 이미 열려 있으면 대기 연장
+    else if (s_state == ELEVATOR_IDLE || s_state == ELEVATOR_DOOR_CLOSING)
+    {
+      if (s_state == ELEVATOR_DOOR_CLOSING) Log_Printf("DOOR REOPEN (OPEN BTN)\r\n");
+      s_state = ELEVATOR_DOOR_OPENING;
+    }
   }
-  if (Button_GetPressed(BTN_CLOSE))
+  /* CLOSE: 문이 열리는 중/열려 있을 때만 즉시 닫기 (이동/EMG/캘리브레이션 중 무시) */
+  if (Button_GetPressed(BTN_CLOSE) && Dwell_CanClose(Beam_IsBlocked()))
   {
-    if (s_state != ELEVATOR_EMG) s_state = ELEVATOR_DOOR_CLOSING;
+    if (s_state == ELEVATOR_DOOR_WAIT) DwellEnd(true);
+    if (s_state == ELEVATOR_DOOR_WAIT || s_state == ELEVATOR_DOOR_OPENING) s_state = ELEVATOR_DOOR_CLOSING;
   }
 
   /* 내부 */
@@ -178,17 +827,54 @@ void Elevator_Task(void)
 {
   UpdateFloorFromPhoto();
 
+  if (s_dwellStatsReset)
+  {
+    s_dwellStatsReset = false;
+    Dwell_ResetStats();
+  }
+
+  /* 주차(IDLE + 문 닫힘) 중에만 스텝모터 코일 OFF 허용 */
+  Stepper_SetParked(s_motor, s_state == ELEVATOR_IDLE && Servo_IsClosed());
+
   switch (s_state)
   {
     case ELEVATOR_EMG:
       ledOff();
-      Stepper_Stop();
+      /* 비상 감속 중에는 그대로 두고, 그 외 회전은 즉시 정지 */
+      if (Stepper_IsBusy(s_motor) && !Stepper_IsEmergencyStopping(s_motor)) Stepper_Stop(s_motor);
+
+      /* 비상 감속 완료: 중단된 이동(레벨링/캘리브레이션/저속 재시도) 상태를 정리해야
+       * RESUME 후 다음 이동이 처음부터 레벨링된다 */
+      if (s_emgReport && !Stepper_IsBusy(s_motor))
+      {
+        Log_Printf("EMG STOPPED: %lu steps\r\n", (unsigned long)Stepper_GetEmgStopSteps(s_motor));
+        FinishMove();
+        s_emgReport = false;
+      }
       return;
 
+    case ELEVATOR_CALIBRATING:
+      CalibrationTask();
+      break;
+
     case ELEVATOR_IDLE:
     {
       ledOff();
 
+      /* 학습된 방향별 CRUISE 저장(변화가 클 때만) */
+      TuneSaveIfNeeded();
+
+      /* UART 설정 변경은 출발 전에 적용 (이번 루프의 이동 시작부터 새 설정) */
+      ApplyStepperRequests();
+
+      /* 캘리브레이션 요청은 정지(IDLE) 상태에서만 시작 */
+      if (s_calRequest)
+      {
+        s_calRequest = false;
+        StartCalibration();
+        break;
+      }
+
       if (ShouldStopHere(s_curFloor, ELEVATOR_IDLE))
       {
         ConsumeStopRequests(s_curFloor);
@@ -210,22 +896,28 @@ void Elevator_Task(void)
     {
       ledUp();
 
+      if (HandleShaftFault()) break;
+
       if (HAL_GetTick() - s_moveStartTick > MOVE_TIMEOUT_MS)
       {
-        Stepper_Stop();
-        ledOff();
-        s_state = ELEVATOR_IDLE;
-        Log_Printf("MOVE TIMEOUT -> IDLE\r\n");
+        MoveTimeout();
         break;
       }
 
-      if (ReachedTarget())
+      /* 목표층 감지 -> 센서 창 중앙까지 레벨링 후 도착 처리 */
+      if (!s_leveling && ReachedTarget()) StartLeveling(DIR_UP);
+      AdvanceOpenTask(ELEVATOR_MOVING_UP);
+
+      if (s_leveling && LevelTask())
       {
-        Stepper_Stop();
+        if (s_tripClean) TuneRaise(s_moveDir);   // 이상 없이 도착: 이 방향 CRUISE 조금 올림
+        FinishMove();
         Log_Printf("ARRIVE %u\r\n", s_curFloor);
 
-        if (ShouldStopHere(s_curFloor, ELEVATOR_MOVING_UP))
+        /* 문을 미리 열기 시작했으면 반드시 정지 처리 */
+        if (s_advOpen || ShouldStopHere(s_curFloor, ELEVATOR_MOVING_UP))
         {
+          s_advOpen = false;
           ConsumeStopRequests(s_curFloor);
           s_state = ELEVATOR_DOOR_OPENING;
         }
@@ -243,22 +935,28 @@ void Elevator_Task(void)
     {
       ledDown();
 
+      if (HandleShaftFault()) break;
+
       if (HAL_GetTick() - s_moveStartTick > MOVE_TIMEOUT_MS)
       {
-        Stepper_Stop();
-        ledOff();
-        s_state = ELEVATOR_IDLE;
-        Log_Printf("MOVE TIMEOUT -> IDLE\r\n");
+        MoveTimeout();
         break;
       }
 
-      if (ReachedTarget())
+      /* 목표층 감지 -> 센서 창 중앙까지 레벨링 후 도착 처리 */
+      if (!s_leveling && ReachedTarget()) StartLeveling(DIR_DOWN);
+      AdvanceOpenTask(ELEVATOR_MOVING_DOWN);
+
+      if (s_leveling && LevelTask())
       {
-        Stepper_Stop();
+        if (s_tripClean) TuneRaise(s_moveDir);   // 이상 없이 도착: 이 방향 CRUISE 조금 올림
+        FinishMove();
         Log_Printf("ARRIVE %u\r\n", s_curFloor);
 
-        if (ShouldStopHere(s_curFloor, ELEVATOR_MOVING_DOWN))
+        /* 문을 미리 열기 시작했으면 반드시 정지 처리 */
+        if (s_advOpen || ShouldStopHere(s_curFloor, ELEVATOR_MOVING_DOWN))
         {
+          s_advOpen = false;
           ConsumeStopRequests(s_curFloor);
           s_state = ELEVATOR_DOOR_OPENING;
         }
@@ -277,7 +975,7 @@ void Elevator_Task(void)
       Servo_Open();
       if (Servo_IsOpened())
       {
-        s_doorTick = HAL_GetTick();
+        DwellBegin();
         s_state = ELEVATOR_DOOR_WAIT;
         Log_Printf("DOOR OPEN\r\n");
       }
@@ -285,22 +983,51 @@ void Elevator_Task(void)
 
     case ELEVATOR_DOOR_WAIT:
       ledOff();
-      if (HAL_GetTick() - s_doorTick >= DOOR_WAIT_MS_DEFAULT)
+      /* 열려 있는 동안 같은 층 호출: 요청만 지우고 대기 연장
+       * (s_dwellHall은 DwellBegin이 정한 기준이라 여기서 바꾸지 않음) */
+      if (ShouldStopHere(s_curFloor, ELEVATOR_IDLE))
+      {
+        ClearStopRequests(s_curFloor);
+        DwellExtend();
+      }
+      if (DwellTask())
       {
+        DwellEnd(false);
         s_state = ELEVATOR_DOOR_CLOSING;
       }
       break;
 
     case ELEVATOR_DOOR_CLOSING:
       ledOff();
+      /* 닫히는 중 같은 층 호출(카/홀): 완전히 닫을 때까지 기다리지 않고
+       * 현재 위치에서 바로 되열기 (OPEN 버튼은 Elevator_InputTask에서 같은 전이) */
+      if (ShouldStopHere(s_curFloor, ELEVATOR_IDLE))
+      {
+        ConsumeStopRequests(s_curFloor);
+        s_state = ELEVATOR_DOOR_OPENING;
+        Servo_Open();
+        Log_Printf("DOOR REOPEN@%u\r\n", s_curFloor);
+        break;
+      }
+
+      /* 닫히는 중 빔 끊김: 사람/물건이 문 사이에 있음 -> 바로 되열기 */
+      if (Dwell_ShouldReopen(Beam_IsBlocked()))
+      {
+        s_state = ELEVATOR_DOOR_OPENING;
+        Servo_Open();
+        Log_Printf("DOOR REOPEN (BEAM)\r\n");
+        break;
+      }
+
       Servo_Close();
       if (Servo_IsClosed())
       {
         Log_Printf("DOOR CLOSE\r\n");
+        s_dwellHall = false;   // 열리는 중 CLOSE로 대기 없이 닫힌 경우
         uint8_t next;
         if (PickNextTarget(ELEVATOR_IDLE, &next))
         {
-          if (next == s_curFloor) s_state = ELEVATOR_DOOR_OPENING;
+          if (next == s_curFloor) { ConsumeStopRequests(s_curFloor); s_state = ELEVATOR_DOOR_OPENING; }
           else StartMoveTo(next);
         }
         else
@@ -318,7 +1045,8 @@ ELEVATOR_STATE Elevator_GetState(void) { return s_state; }
 
 void Elevator_ResumeFromEMG(void)
 {
-  if (s_state == ELEVATOR_EMG)
+  /* 비상 감속이 끝나고 Elevator_Task가 이동 상태를 정리하기 전에는 재출발하지 않음 */
+  if (s_state == ELEVATOR_EMG && !Stepper_IsBusy(s_motor) && !s_emgReport)
   {
     s_state = ELEVATOR_IDLE;
   }
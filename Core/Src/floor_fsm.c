@@ -8,43 +8,73 @@
 
 #include "floor_fsm.h"
 
-floor_state_t FloorFSM_Decode(uint8_t p1, uint8_t p2, uint8_t p3)
-{
-  uint8_t sum = (uint8_t)(p1 + p2 + p3);
-
-  if (sum == 0) return FS_UNKNOWN;
-
-  // 하나만 1이면 확정층
-  if (sum == 1)
-  {
-    if (p1) return FS_F1;
-    if (p2) return FS_F2;
-    if (p3) return FS_F3;
-  }
-
-  // 두 개가 1이면 "사이" 구간
-  if (sum == 2)
-  {
-    if (p1 && p2 && !p3) return FS_MOVE_1_2; // 1~2
-    if (!p1 && p2 && p3) return FS_MOVE_2_3; // 2~3
-    return FS_ERROR; // (p1&p3) 같은 비정상
-  }
-
-  // 3개 다 1이면 비정상
-  return FS_ERROR;
+
+/* ==============================
+ *        승강로 센서 배치
+ * ==============================
+ * 유효한 RAW 조합만 나열한다. 표에 없는 조합은 모두 PF_ERROR.
+ * - 층 f      : 센서 f 하나만 감지
+ * - 층 f~f+1  : 이웃한 센서 f, f+1 동시 감지
+ * - 000       : 센서 사이(이동중)
+ * RAW 비트: bit0=P1, bit1=P2, bit2=P3
+ */
+typedef struct
+{
+  uint8_t     raw;
+  photo_fsm_t state;
+} floor_layout_t;
+
+static const floor_layout_t s_layout[] =
+{
+  { 0x0, PF_UNKNOWN  },
+  { 0x1, PF_F1       },
+  { 0x3, PF_MOVE_1_2 },
+  { 0x2, PF_F2       },
+  { 0x6, PF_MOVE_2_3 },
+  { 0x4, PF_F3       },
+};
+
+/* 상태별 층 번호 / 표시 문자열 (PF_COUNT 크기) */
+static const uint8_t s_floorOf[PF_COUNT] =
+{
+  [PF_F1] = 1, [PF_F2] = 2, [PF_F3] = 3,
+};
+
+static const char *const s_name[PF_COUNT] =
+{
+  [PF_UNKNOWN]  = "MOVING",
+  [PF_F1]       = "FLOOR=1",
+  [PF_F2]       = "FLOOR=2",
+  [PF_F3]       = "FLOOR=3",
+  [PF_MOVE_1_2] = "MOVE 1~2",
+  [PF_MOVE_2_3] = "MOVE 2~3",
+  [PF_ERROR]    = "ERROR",
+};
+
+
+/* RAW -> 상태 룩업 테이블 (2^N) */
+static uint8_t s_lut[1U << FLOOR_FSM_SENSORS];
+
+
+void FloorFSM_Init(void)
+{
+  for (uint32_t r = 0; r < (1U << FLOOR_FSM_SENSORS); r++) s_lut[r] = PF_ERROR;
+
+  for (uint32_t i = 0; i < sizeof(s_layout) / sizeof(s_layout[0]); i++)
+    s_lut[s_layout[i].raw & FLOOR_FSM_RAW_MASK] = (uint8_t)s_layout[i].state;
 }
 
-const char* FloorFSM_ToString(floor_state_t s)
-{
-  switch (s)
-  {
-    case FS_F1:       return "FLOOR=1";
-    case FS_MOVE_1_2: return "MOVE 1~2";
-    case FS_F2:       return "FLOOR=2";
-    case FS_MOVE_2_3: return "MOVE 2~3";
-    case FS_F3:       return "FLOOR=3";
-    case FS_UNKNOWN:  return "MOVING";
-    case FS_ERROR:    return "ERROR";
-    default:          return "?";
-  }
+photo_fsm_t FloorFSM_Decode(uint8_t raw)
+{
+  return (photo_fsm_t)s_lut[raw & FLOOR_FSM_RAW_MASK];
+}
+
+uint8_t FloorFSM_FloorOf(photo_fsm_t s)
+{
+  return ((uint32_t)s < PF_COUNT) ? s_floorOf[s] : 0;
+}
+
+const char* FloorFSM_ToString(photo_fsm_t s)
+{
+  return ((uint32_t)s < PF_COUNT) ? s_name[s] : "?";
 }
@@ -10,8 +10,9 @@
 #include "fnd.h"
 #include "delay.h"
 
-// 화면 버퍼 (내부 전역 변수)
-static uint8_t display_buffer[4] = {PAT_BLANK, PAT_BLANK, PAT_BLANK, PAT_BLANK};
+// 화면 버퍼 (내부 전역 변수, main loop에서 쓰고 TIM3 ISR에서 읽음)
+static volatile uint8_t display_buffer[4] = {PAT_BLANK, PAT_BLANK, PAT_BLANK, PAT_BLANK};
+static uint8_t scan_pos = 0;   // 다음에 켤 자리(0~3), ISR 전용
 
 
 // ---------------------------------------------------------
@@ -80,19 +81,14 @@ void setFndState(uint8_t floor, uint8_t isDoorOpen)
 }
 
 void displayScan(void) {
-    for (uint8_t i = 0; i < 4; i++) {
-        // 잔상 제거를 위해 끄기
-        DIG_Off();
+    // 잔상 제거를 위해 끄기
+    DIG_Off();
 
-        // 데이터 전송
-        dataOut(display_buffer[i]);
+    // 데이터 전송
+    dataOut(display_buffer[scan_pos]);
 
-        // 자리 켜기
-        DIG_Select(i);
+    // 자리 켜기 (다음 타이머 틱까지 2.5ms 유지, Duty 100%)
+    DIG_Select(scan_pos);
 
-        // 최대 밝기 유지 (2.5ms)
-        delay_us(2500);
-
-        // 끄는 시간 없음 (Duty 100%)
-    }
+    scan_pos = (scan_pos + 1) & 0x03;
 }
@@ -18,6 +18,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "dma.h"
 #include "tim.h"
 #include "usart.h"
 #include "gpio.h"
@@ -41,6 +42,8 @@
 
 #include "logger.h"
 #include "photo.h"
+#include "beam.h"
+#include "fnd.h"
 
 
 
@@ -76,6 +79,23 @@ void SystemClock_Config(void);
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
   Photo_OnExti(GPIO_Pin);
+  Beam_OnExti(GPIO_Pin);
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM3)
+  {
+    displayScan();   // FND 1자리씩 갱신
+  }
+}
+
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM4)
+  {
+    Stepper_OnTimerIrq(htim->Channel);   // 채널별 모터 스텝 진행 / CH2 감전류 홀드(초핑)
+  }
 }
 
 
@@ -117,9 +137,13 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_TIM1_Init();
   MX_USART2_UART_Init();
   MX_TIM11_Init();
+  MX_TIM3_Init();
+  MX_TIM4_Init();
+  MX_TIM5_Init();
   /* USER CODE BEGIN 2 */
 
 
@@ -132,6 +156,8 @@ int main(void)
 
   HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
   HAL_TIM_Base_Start(&htim11); // delay_us용 타이머 시작
+  HAL_TIM_Base_Start(&htim5);  // 32bit 1us 타임스탬프(포토 에지)
+  HAL_TIM_Base_Start_IT(&htim3); // FND 리프레시 타이머 시작
 
 
 
@@ -0,0 +1,115 @@
+/*
+ * param.c
+ *
+ *  - 파라미터 구조체를 FLASH Sector 7에 저장/복원
+ *  - 읽기는 메모리 맵 주소에서 바로 memcpy, 쓰기는 HAL FLASH API(word 단위)
+ */
+
+
+#include "param.h"
+#include <stddef.h>
+#include <string.h>
+
+
+/* ==============================
+ *        내부 상태 변수
+ * ============================== */
+static param_t s_param;          // RAM 사본
+static bool    s_valid = false;  // FLASH 값이 유효했는지
+
+
+/* CRC32 (IEEE, 비트 단위): 설정 저장/부팅 시 1회라 테이블 없이 계산 */
+static uint32_t Crc32(const uint8_t *p, uint32_t len)
+{
+  uint32_t crc = 0xFFFFFFFFUL;
+
+  while (len--)
+  {
+    crc ^= *p++;
+    for (uint8_t b = 0; b < 8; b++)
+      crc = (crc & 1U) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+  }
+  return ~crc;
+}
+
+static uint32_t ParamCrc(const param_t *p)
+{
+  return Crc32((const uint8_t *)p, (uint32_t)offsetof(param_t, crc));
+}
+
+
+/* 기본값: shaft map은 "미보정" */
+static void SetDefaults(void)
+{
+  memset(&s_param, 0, sizeof(s_param));
+  s_param.magic   = PARAM_MAGIC;
+  s_param.version = PARAM_VERSION;
+
+  for (uint8_t d = 0; d < 2; d++)
+    for (uint8_t f = 0; f <= SHAFT_FLOORS; f++)
+    {
+      s_param.shaft.lo[d][f] = SHAFT_POS_NONE;
+      s_param.shaft.hi[d][f] = SHAFT_POS_NONE;
+    }
+  s_param.shaft.valid = 0;
+}
+
+
+void Param_Init(void)
+{
+  const param_t *flash = (const param_t *)PARAM_FLASH_ADDR;
+
+  if (flash->magic == PARAM_MAGIC && flash->version == PARAM_VERSION &&
+      flash->crc == ParamCrc(flash))
+  {
+    memcpy(&s_param, flash, sizeof(s_param));
+    s_valid = true;
+  }
+  else
+  {
+    SetDefaults();
+    s_valid = false;
+  }
+}
+
+bool Param_IsValid(void) { return s_valid; }
+
+param_t* Param_Get(void) { return &s_param; }
+
+
+bool Param_Save(void)
+{
+  s_param.magic   = PARAM_MAGIC;
+  s_param.version = PARAM_VERSION;
+  s_param.crc     = ParamCrc(&s_param);
+
+  HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+                         FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+
+  /* 1) 섹터 지우기 */
+  FLASH_EraseInitTypeDef erase = {0};
+  uint32_t sectorError = 0;
+  erase.TypeErase    = FLASH_TYPEERASE_SECTORS;
+  erase.Sector       = PARAM_FLASH_SECTOR;
+  erase.NbSectors    = 1;
+  erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;   // 3.3V: word 단위 쓰기 가능
+
+  bool ok = (HAL_FLASHEx_Erase(&erase, &sectorError) == HAL_OK);
+
+  /* 2) word 단위 쓰기 (param_t는 4바이트 정렬) */
+  const uint32_t *src = (const uint32_t *)&s_param;
+  for (uint32_t i = 0; ok && i < sizeof(s_param) / 4; i++)
+  {
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, PARAM_FLASH_ADDR + i * 4, src[i]) != HAL_OK)
+      ok = false;
+  }
+
+  HAL_FLASH_Lock();
+
+  /* 3) 검증 */
+  if (ok) ok = (memcmp((const void *)PARAM_FLASH_ADDR, &s_param, sizeof(s_param)) == 0);
+
+  s_valid = ok;
+  return ok;
+}
@@ -7,12 +7,14 @@
  *
  *  -  포토센서 3개 입력을 읽어 층/이동구간을 판단한다.
  *  - 빔이 끊기면 LOW(RESET)인 센서 기준으로 작성됨
- *  - EXTI 발생 시 pending 플래그만 세우고, 실제 판독은 Task에서 디바운스 후 수행
+ *  - EXTI 발생 시 (us 타임스탬프, 센서, 핀 상태)를 에지 큐에 넣고,
+ *    Task에서 꺼내 짧은 글리치 필터 후 확정 (기존 ms 디바운스보다 지연이 훨씬 짧음)
  *  - EXTI 놓침 대비 폴링도 함께 수행
  */
 
 
 #include "photo.h"
+#include "tim.h"
 
 /* ==============================
  *         핀 매핑
@@ -37,118 +39,155 @@ static inline uint8_t Detected(GPIO_TypeDef *port, uint16_t pin)
 }
 
 
-/* EXTI 디바운스 시간 */
-#define PHOTO_DEBOUNCE_MS  30
+/* 글리치 필터: 에지 후 이 시간 동안 되돌아가지 않아야 확정 (기존 30ms 디바운스 대체) */
+#define PHOTO_GLITCH_US  2000
+#define PHOTO_POLL_MS    50
+
+/* 에지 큐 크기(2의 거듭제곱) */
+#define PHOTO_EDGE_QLEN  16
+#define PHOTO_EDGE_MASK  (PHOTO_EDGE_QLEN - 1)
 
 
 /* ==============================
  *        내부 상태 변수
  * ============================== */
-static volatile uint8_t  s_irq_pending = 0;   // EXTI 발생 여부(플래그)
-static volatile uint32_t s_irq_tick = 0;      // EXTI 발생 시각
-
-static uint8_t  s_p1=0, s_p2=0, s_p3=0;       // 마지막으로 확정된 RAW 값
+static uint8_t  s_raw = 0;                    // 마지막으로 확정된 RAW 값(bit0=P1, bit1=P2, bit2=P3)
 static uint8_t  s_valid = 0;                  // 초기값 읽었는지 표시(사실상 항상 1로 유지)
 static uint32_t s_boot_tick = 0;              // 부팅 직후 튐 방지용
 
+static uint8_t  s_pend = 0;                   // 큐에서 꺼낸 에지까지 반영한 RAW(확정 전)
+static uint32_t s_pendUs = 0;                 // s_pend를 만든 마지막 에지 시각
+static uint32_t s_stateUs = 0;                // s_raw를 만든 에지 시각
+static uint32_t s_pollTick = 0;
 
-/* 현재 RAW를 즉시 읽는 함수 */
-static void ReadNow(uint8_t *o1, uint8_t *o2, uint8_t *o3)
-{
-  *o1 = Detected(PHOTO1_PORT, PHOTO1_PIN);
-  *o2 = Detected(PHOTO2_PORT, PHOTO2_PIN);
-  *o3 = Detected(PHOTO3_PORT, PHOTO3_PIN);
-}
+static photo_edge_t s_last[PHOTO_SENSORS];    // 센서별 마지막 에지
+static uint8_t      s_lastValid = 0;          // bit i: s_last[i] 유효
 
 
-/* RAW 조합을 FSM 상태로 변환 */
-static photo_fsm_t DecodeFSM(uint8_t p1, uint8_t p2, uint8_t p3)
+/* ==============================
+ *        에지 큐 (SPSC)
+ * ==============================
+ * 생산자: EXTI ISR(Photo_OnExti) -> s_qHead만 씀
+ * 소비자: main(Photo_Task)       -> s_qTail만 씀
+ * 인덱스는 8bit로 계속 증가시키고 MASK로 자리 계산 (QLEN <= 128)
+ * 데이터를 다 쓴 뒤 인덱스를 올리도록 __DMB로 순서 보장
+ */
+static photo_edge_t      s_q[PHOTO_EDGE_QLEN];
+static volatile uint8_t  s_qHead = 0;
+static volatile uint8_t  s_qTail = 0;
+static volatile uint32_t s_qDrops = 0;
+
+static bool PopEdge(photo_edge_t *out)
 {
-  uint8_t sum = (uint8_t)(p1 + p2 + p3);
+  uint8_t t = s_qTail;
+  if (t == s_qHead) return false;
 
-  /* 아무 것도 감지 안됨 -> 이동중으로 표시 */
-  if (sum == 0) return PF_UNKNOWN;
+  *out = s_q[t & PHOTO_EDGE_MASK];
+  __DMB();
+  s_qTail = (uint8_t)(t + 1);
+  return true;
+}
 
-  /* 정확히 하나만 감지되면 해당 층 */
-  if (sum == 1)
-  {
-    if (p1) return PF_F1;
-    if (p2) return PF_F2;
-    if (p3) return PF_F3;
-  }
 
-  /* 두 개가 동시에 감지되면 층 사이 구간 */
-  if (sum == 2)
-  {
-    if (p1 && p2 && !p3) return PF_MOVE_1_2;
-    if (!p1 && p2 && p3) return PF_MOVE_2_3;
-    return PF_ERROR;   // p1&p3 같이 비정상
-  }
+/* 센서 i(0~2) 핀 */
+static GPIO_TypeDef *const s_port[PHOTO_SENSORS] = { PHOTO1_PORT, PHOTO2_PORT, PHOTO3_PORT };
+static const uint16_t      s_pin[PHOTO_SENSORS]  = { PHOTO1_PIN,  PHOTO2_PIN,  PHOTO3_PIN  };
+
 
-  /* 3개 모두 감지 등은 비정상 */
-  return PF_ERROR;
+/* 현재 RAW를 즉시 읽는 함수 (floor_fsm 비트 순서) */
+static uint8_t ReadNow(void)
+{
+  uint8_t raw = 0;
+  for (uint8_t i = 0; i < PHOTO_SENSORS; i++)
+    raw |= (uint8_t)(Detected(s_port[i], s_pin[i]) << i);
+  return raw;
+}
+
+uint32_t Photo_NowUs(void)
+{
+  return htim5.Instance->CNT;
 }
 
 void Photo_Init(void)
 {
-  s_irq_pending = 0;
-  s_irq_tick = 0;
+  s_qTail = s_qHead;
   s_boot_tick = HAL_GetTick();
+  FloorFSM_Init();
 
   /* 부팅 직후 현재 상태를 1회 읽어서 기준값으로 사용 */
-  ReadNow(&s_p1, &s_p2, &s_p3);
+  s_raw = ReadNow();
+  s_pend = s_raw;
+  s_stateUs = s_pendUs = Photo_NowUs();
+  s_pollTick = HAL_GetTick();
+  s_lastValid = 0;
   s_valid = 1;
 }
 
-/* EXTI 콜백에서 호출: 실제 읽기는 Task에서 디바운스 후 처리 */
+/* EXTI 콜백에서 호출: 타임스탬프/핀 상태만 큐에 넣고, 판정은 Task에서 */
 void Photo_OnExti(uint16_t GPIO_Pin)
 {
   /* 부팅 직후 센서 튐/불안정 방지 */
   if (HAL_GetTick() - s_boot_tick < 200) return;
 
   /* 이 구현은 핀 번호만 비교(포트까지는 확인 안함) */
-  if (GPIO_Pin == PHOTO1_PIN || GPIO_Pin == PHOTO2_PIN || GPIO_Pin == PHOTO3_PIN)
+  for (uint8_t i = 0; i < PHOTO_SENSORS; i++)
   {
-    s_irq_pending = 1;
-    s_irq_tick = HAL_GetTick();
+    if (GPIO_Pin != s_pin[i]) continue;
+
+    uint8_t h = s_qHead;
+    if ((uint8_t)(h - s_qTail) >= PHOTO_EDGE_QLEN)
+    {
+      s_qDrops++;   // 백업 폴링이 최종 상태는 맞춰 줌
+      return;
+    }
+
+    photo_edge_t *e = &s_q[h & PHOTO_EDGE_MASK];
+    e->us       = Photo_NowUs();
+    e->sensor   = i;
+    e->detected = Detected(s_port[i], s_pin[i]);
+    __DMB();
+    s_qHead = (uint8_t)(h + 1);
+    return;
   }
 }
 
 /* 변경이 있으면 1 반환 */
 uint8_t Photo_Task(void)
 {
-  uint32_t now = HAL_GetTick();
+  uint32_t nowUs = Photo_NowUs();
   uint8_t changed = 0;
+  photo_edge_t e;
 
-  /* 1) EXTI 기반 갱신 */
-  if (s_irq_pending)
+  /* 1) 에지 큐 반영 */
+  while (PopEdge(&e))
   {
-    /* 디바운스 시간 대기 */
-    if (now - s_irq_tick < PHOTO_DEBOUNCE_MS) return 0;
-    s_irq_pending = 0;
-
-    uint8_t n1,n2,n3;
-    ReadNow(&n1,&n2,&n3);
+    uint8_t bit = (uint8_t)(1U << e.sensor);
+    s_pend = e.detected ? (uint8_t)(s_pend | bit) : (uint8_t)(s_pend & ~bit);
+    s_pendUs = e.us;
 
-    if (n1!=s_p1 || n2!=s_p2 || n3!=s_p3)
-    {
-      s_p1=n1; s_p2=n2; s_p3=n3;
-      changed = 1;
-    }
+    s_last[e.sensor] = e;
+    s_lastValid |= bit;
   }
 
-  /* 2) 백업 폴링(EXTI miss 대비) */
-  static uint32_t pollTick = 0;
-  if (now - pollTick >= 50)
+  /* 마지막 에지 후 글리치 시간 동안 유지되면 확정 (되돌아갔으면 s_pend == s_raw) */
+  if (s_pend != s_raw && (uint32_t)(nowUs - s_pendUs) >= PHOTO_GLITCH_US)
   {
-    pollTick = now;
+    s_raw = s_pend;
+    s_stateUs = s_pendUs;
+    changed = 1;
+  }
 
-    uint8_t n1,n2,n3;
-    ReadNow(&n1,&n2,&n3);
+  /* 2) 백업 폴링(EXTI miss / 큐 넘침 대비): 확정 대기 중인 에지가 없을 때만 */
+  uint32_t now = HAL_GetTick();
+  if (now - s_pollTick >= PHOTO_POLL_MS)
+  {
+    s_pollTick = now;
 
-    if (n1!=s_p1 || n2!=s_p2 || n3!=s_p3)
+    uint8_t n = ReadNow();
+    if (n != s_raw && s_pend == s_raw)
     {
-      s_p1=n1; s_p2=n2; s_p3=n3;
+      s_raw = s_pend = n;
+      s_stateUs = s_pendUs = nowUs;
       changed = 1;
     }
   }
@@ -158,28 +197,24 @@ uint8_t Photo_Task(void)
 
 void Photo_GetRaw(uint8_t *p1, uint8_t *p2, uint8_t *p3)
 {
-  if (p1) *p1 = s_p1;
-  if (p2) *p2 = s_p2;
-  if (p3) *p3 = s_p3;
+  if (p1) *p1 = (s_raw >> 0) & 1U;
+  if (p2) *p2 = (s_raw >> 1) & 1U;
+  if (p3) *p3 = (s_raw >> 2) & 1U;
 }
 
 photo_fsm_t Photo_GetFSM(void)
 {
   if (!s_valid) return PF_UNKNOWN;
-  return DecodeFSM(s_p1, s_p2, s_p3);
+  return FloorFSM_Decode(s_raw);
 }
 
-const char* Photo_FSM_ToString(photo_fsm_t f)
+uint32_t Photo_GetStateUs(void) { return s_stateUs; }
+
+bool Photo_GetLastEdge(uint8_t sensor, photo_edge_t *out)
 {
-  switch (f)
-  {
-    case PF_F1:       return "FLOOR=1";
-    case PF_F2:       return "FLOOR=2";
-    case PF_F3:       return "FLOOR=3";
-    case PF_MOVE_1_2: return "MOVE 1~2";
-    case PF_MOVE_2_3: return "MOVE 2~3";
-    case PF_UNKNOWN:  return "MOVING";
-    case PF_ERROR:    return "ERROR";
-    default:          return "?";
-  }
+  if (sensor >= PHOTO_SENSORS || !out || !(s_lastValid & (1U << sensor))) return false;
+  *out = s_last[sensor];
+  return true;
 }
+
+uint32_t Photo_GetEdgeDrops(void) { return s_qDrops; }
@@ -14,6 +14,9 @@
 #include "elevator.h"
 #include "photo.h"
 #include "servo.h"
+#include "stepper.h"
+#include "shaft.h"
+#include "beam.h"
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -28,6 +31,8 @@ static uint8_t  s_rx_ch = 0;            // 1바이트 수신 버퍼
 static char     s_line[64];             // 라인 버퍼
 static uint8_t  s_len = 0;              // 현재 라인 길이
 
+static volatile bool s_benchRequest = false;   // BENCH 대기(측정은 Task에서: IRQ를 ~1ms 막음)
+
 
 /* 1바이트 Rx 인터럽트 재시작 */
 static void StartRxIT(void)
@@ -53,42 +58,16 @@ static const char* StateToStr(ELEVATOR_STATE st)
     case ELEVATOR_DOOR_WAIT:    return "DOOR_OPEN";
     case ELEVATOR_DOOR_CLOSING: return "DOOR_CLOSING";
     case ELEVATOR_EMG:          return "EMG_STOP";
+    case ELEVATOR_CALIBRATING:  return "CALIBRATING";
     default:                    return "?";
   }
 }
 
-static const char* PhotoToStr(photo_fsm_t f)
-{
-  switch (f)
-  {
-    case PF_F1:       return "FLOOR=1";
-    case PF_F2:       return "FLOOR=2";
-    case PF_F3:       return "FLOOR=3";
-    case PF_MOVE_1_2: return "MOVE 1~2";
-    case PF_MOVE_2_3: return "MOVE 2~3";
-    case PF_UNKNOWN:  return "MOVING";
-    case PF_ERROR:    return "ERROR";
-    default:          return "?";
-  }
-}
-
-
-
-
 /* 거주자 UI는 단순히 FLOOR / MOVING / ERROR 정도만 보여주기 */
 static const char* SimpleStateStr(photo_fsm_t f)
 {
-  switch (f)
-  {
-    case PF_F1:       return "FLOOR=1";
-    case PF_F2:       return "FLOOR=2";
-    case PF_F3:       return "FLOOR=3";
-    case PF_MOVE_1_2: return "MOVING";
-    case PF_MOVE_2_3: return "MOVING";
-    case PF_UNKNOWN:  return "MOVING";
-    case PF_ERROR:    return "ERROR";
-    default:          return "MOVING";
-  }
+  if (FloorFSM_FloorOf(f) || f == PF_ERROR) return FloorFSM_ToString(f);
+  return "MOVING";
 }
 
 
@@ -118,6 +97,23 @@ static void PrintHelp(void)
     "  CALL 1|2|3\r\n"
     "  STATUS\r\n"
     "  RESUME\r\n"
+    "  PROFILE CONST|TRAP|SCURVE\r\n"
+    "  BENCH\r\n"
+    "  STEPDMA ON|OFF\r\n"
+    "  DRIVE HALF|FULL|WAVE\r\n"
+    "  CALIBRATE\r\n"
+    "  SHAFT\r\n"
+    "  POWER\r\n"
+    "  DOORTIME [open_ms close_ms]\r\n"
+    "  DOOREASE LINEAR|SMOOTH|SMOOTHER\r\n"
+    "  DOORCAL [closed_us opened_us]\r\n"
+    "  ADVOPEN [OFF|steps]\r\n"
+    "  DWELL [RESET]\r\n"
+#ifdef BEAM_SIM
+    "  BEAM [ON|OFF|SIM OFF|CLEAR|BLOCK]\r\n"
+#else
+    "  BEAM [ON|OFF]\r\n"
+#endif
     "  HELP\r\n"
   );
 }
@@ -138,15 +134,95 @@ static void PrintStatus(void)
   char qbuf[64];
   Elevator_GetQueueString(qbuf, sizeof(qbuf));
 
-  Log_Printf("RAW=%u%u%u %s\r\n", p1,p2,p3, PhotoToStr(pf));
+  Log_Printf("RAW=%u%u%u %s\r\n", p1,p2,p3, FloorFSM_ToString(pf));
   Log_Printf("FLOOR=%u\r\n", cur);
   Log_Printf("STATE=%s\r\n", StateToStr(st));
   Log_Printf("DOOR=%s\r\n", door);
+  Log_Printf("POS=%ld\r\n", (long)Stepper_GetPosition(&hstepper1));
+  Log_Printf("CRUISE UP=%u DOWN=%u\r\n", Stepper_GetDirCruise(&hstepper1, DIR_UP), Stepper_GetDirCruise(&hstepper1, DIR_DOWN));
   Log_Printf("QUEUE=%s\r\n", qbuf);
 }
 
 
+/* shaft map 출력: 층별 구간 경계(UP/DOWN 통과 시 위치) */
+static void PrintShaft(void)
+{
+  const shaft_map_t *m = Shaft_GetMap();
+
+  Log_Printf("SHAFT MAP=%s REF=%s\r\n", m->valid ? "OK" : "NONE",
+             Shaft_IsReferenced() ? "Y" : "N");
+  if (!m->valid) return;
+
+  for (uint8_t f = 1; f <= SHAFT_FLOORS; f++)
+  {
+    Log_Printf("F%u UP lo=%ld hi=%ld  DN lo=%ld hi=%ld\r\n", f,
+               (long)m->lo[0][f], (long)m->hi[0][f],
+               (long)m->lo[1][f], (long)m->hi[1][f]);
+  }
+}
+
+
+/* 스텝모터 코일 전원 상태별 누적 시간/추정 에너지 */
+static void PrintPower(void)
+{
+  static const char *const name[STEPPER_POWER_COUNT] = { "RUN", "HOLD", "REDUCED", "OFF" };
+  stepper_power_stats_t st;
+  Stepper_GetPowerStats(&hstepper1, &st);
+
+  Log_Printf("PWR=%s\r\n", name[Stepper_GetPowerState(&hstepper1)]);
+  for (uint8_t i = 0; i < STEPPER_POWER_COUNT; i++)
+  {
+    Log_Printf("%-7s t=%lu.%03lus E=%lumJ\r\n", name[i],
+               (unsigned long)(st.ms[i] / 1000), (unsigned long)(st.ms[i] % 1000),
+               (unsigned long)st.mj[i]);
+  }
+}
+
+static void PrintDwell(void)
+{
+  elevator_dwell_stats_t st;
+  Elevator_GetDwellStats(&st);
+
+  if (st.count == 0)
+  {
+    Log_Printf("DWELL: no data\r\n");
+    return;
+  }
+  Log_Printf("DWELL N=%lu AVG=%lu MIN=%lu MAX=%lu ms\r\n", (unsigned long)st.count,
+             (unsigned long)(st.totalMs / st.count), (unsigned long)st.minMs, (unsigned long)st.maxMs);
+  Log_Printf("HALL=%lu SHORT=%lu EXT=%lu CLOSEBTN=%lu\r\n", (unsigned long)st.hallStops,
+             (unsigned long)st.shortened, (unsigned long)st.extended, (unsigned long)st.closeBtn);
+  Log_Printf("BEAM CROSS=%lu REOPEN=%lu\r\n", (unsigned long)st.beamCross, (unsigned long)st.beamReopen);
+}
+
+static void PrintBeam(void)
+{
+#ifdef BEAM_SIM
+  static const char *const sim[] = { "OFF", "CLEAR", "BLOCK" };
+  Log_Printf("BEAM %s %s SIM=%s\r\n", Beam_IsEnabled() ? "ON" : "OFF",
+             Beam_IsBlocked() ? "BLOCKED" : "CLEAR", sim[Beam_GetSim()]);
+#else
+  Log_Printf("BEAM %s %s\r\n", Beam_IsEnabled() ? "ON" : "OFF",
+             Beam_IsBlocked() ? "BLOCKED" : "CLEAR");
+#endif
+}
+
+
 /* 문자열을 대문자로 변환해서 대소문자 입력을 모두 허용 */
+/* phase 출력 벤치 (main 루프에서만: 측정 중 인터럽트를 막음) */
+static void RunBench(void)
+{
+  uint32_t hal, bsrr;
+  if (!Stepper_BenchPhaseOutput(&hstepper1, 1000, &hal, &bsrr))
+  {
+    Log_Printf("ERR: MOTOR BUSY\r\n");
+    return;
+  }
+  /* 1000회 평균: 소수 첫째 자리까지 */
+  Log_Printf("PHASE OUT HAL=%lu.%lu BSRR=%lu.%lu cyc/step\r\n",
+             hal/1000, (hal%1000)/100, bsrr/1000, (bsrr%1000)/100);
+}
+
 static void StrToUpper(char *s)
 {
   for (; *s; s++) *s = (char)toupper((unsigned char)*s);
@@ -184,6 +260,246 @@ static void HandleLine(char *line)
     return;
   }
 
+  if (!strncmp(tmp, "BENCH", 5))
+  {
+    /* 실제 측정은 ResidentUART_Task(main 루프)에서 */
+    s_benchRequest = true;
+    return;
+  }
+
+  if (!strncmp(tmp, "STEPDMA", 7))
+  {
+    char *p = tmp + 7;
+    while (*p==' ' || *p=='\t') p++;
+
+    bool on;
+    if      (!strncmp(p, "ON", 2))  on = true;
+    else if (!strncmp(p, "OFF", 3)) on = false;
+    else
+    {
+      Log_Printf("ERR: STEPDMA ON|OFF\r\n");
+      return;
+    }
+
+    /* 실제 변경은 Elevator_Task에서 카 정지(IDLE) 중에 */
+    Elevator_RequestStepDma(on);
+    Log_Printf("OK: STEPDMA %s (apply when IDLE)\r\n", on ? "ON" : "OFF");
+    return;
+  }
+
+  if (!strncmp(tmp, "CALIBRATE", 9))
+  {
+    /* 실제 주행은 Elevator_Task에서 IDLE일 때 시작 */
+    Elevator_RequestCalibration();
+    Log_Printf("OK: CALIBRATE (start when IDLE)\r\n");
+    return;
+  }
+
+  if (!strncmp(tmp, "POWER", 5))
+  {
+    PrintPower();
+    return;
+  }
+
+  if (!strncmp(tmp, "SHAFT", 5))
+  {
+    PrintShaft();
+    return;
+  }
+
+  if (!strncmp(tmp, "BEAM", 4))
+  {
+    char *p = tmp + 4;
+    while (*p==' ' || *p=='\t') p++;
+
+#ifdef BEAM_SIM
+    if (!strncmp(p, "SIM", 3))
+    {
+      p += 3;
+      while (*p==' ' || *p=='\t') p++;
+      if      (!strncmp(p, "OFF", 3))   Beam_SetSim(BEAM_SIM_OFF);
+      else if (!strncmp(p, "CLEAR", 5)) Beam_SetSim(BEAM_SIM_CLEAR);
+      else if (!strncmp(p, "BLOCK", 5)) Beam_SetSim(BEAM_SIM_BLOCKED);
+      else
+      {
+        Log_Printf("ERR: BEAM SIM OFF|CLEAR|BLOCK\r\n");
+        return;
+      }
+    }
+    else
+#endif
+    if (!strncmp(p, "ON", 2))  Beam_SetEnabled(true);
+    else if (!strncmp(p, "OFF", 3)) Beam_SetEnabled(false);
+    else if (*p != 0)
+    {
+#ifdef BEAM_SIM
+      Log_Printf("ERR: BEAM ON|OFF|SIM OFF|CLEAR|BLOCK\r\n");
+#else
+      Log_Printf("ERR: BEAM ON|OFF\r\n");
+#endif
+      return;
+    }
+    PrintBeam();   // 시뮬레이션 전환은 다음 Beam_Task(<=20ms)에서 반영
+    return;
+  }
+
+  if (!strncmp(tmp, "DWELL", 5))
+  {
+    char *p = tmp + 5;
+    while (*p==' ' || *p=='\t') p++;
+    if (!strncmp(p, "RESET", 5))
+    {
+      Elevator_ResetDwellStats();
+      Log_Printf("OK: DWELL RESET\r\n");
+      return;
+    }
+    PrintDwell();
+    return;
+  }
+
+  if (!strncmp(tmp, "DRIVE", 5))
+  {
+    char *p = tmp + 5;
+    while (*p==' ' || *p=='\t') p++;
+
+    stepper_drive_t mode;
+    if      (!strncmp(p, "HALF", 4)) mode = STEPPER_DRIVE_HALF;
+    else if (!strncmp(p, "FULL", 4)) mode = STEPPER_DRIVE_FULL;
+    else if (!strncmp(p, "WAVE", 4)) mode = STEPPER_DRIVE_WAVE;
+    else
+    {
+      Log_Printf("ERR: DRIVE HALF|FULL|WAVE\r\n");
+      return;
+    }
+
+    /* 실제 변경은 Elevator_Task에서 카 정지(IDLE) 중에: 이동 시작/문 동작/EMG 중 phase가 바뀌는 것 방지 */
+    Elevator_RequestDriveMode(mode);
+    Log_Printf("OK: DRIVE %s (apply when IDLE)\r\n", p);
+    return;
+  }
+
+  if (!strncmp(tmp, "DOORTIME", 8))
+  {
+    char *p = tmp + 8;
+    uint16_t o, c;
+
+    /* 인자 없으면 현재 값 출력 */
+    while (*p==' ' || *p=='\t') p++;
+    if (*p == 0)
+    {
+      Servo_GetStrokeTime(&o, &c);
+      Log_Printf("DOORTIME OPEN=%u CLOSE=%u ms\r\n", o, c);
+      return;
+    }
+
+    char *end;
+    unsigned long ov = strtoul(p, &end, 10);
+    unsigned long cv = strtoul(end, NULL, 10);
+    if (ov > 0xFFFF || cv > 0xFFFF || !Servo_SetStrokeTime((uint16_t)ov, (uint16_t)cv))
+    {
+      Log_Printf("ERR: DOORTIME %u~%u %u~%u\r\n", SERVO_STROKE_MS_MIN, SERVO_STROKE_MS_MAX,
+                 SERVO_STROKE_MS_MIN, SERVO_STROKE_MS_MAX);
+      return;
+    }
+    Log_Printf("OK: DOORTIME OPEN=%lu CLOSE=%lu ms\r\n", ov, cv);
+    return;
+  }
+
+  if (!strncmp(tmp, "DOORCAL", 7))
+  {
+    char *p = tmp + 7;
+    uint16_t cl, op;
+
+    /* 인자 없으면 현재 끝 위치 출력 */
+    while (*p==' ' || *p=='\t') p++;
+    if (*p == 0)
+    {
+      Servo_GetEndpoints(&cl, &op);
+      Log_Printf("DOORCAL CLOSED=%u OPENED=%u us\r\n", cl, op);
+      return;
+    }
+
+    char *end;
+    unsigned long cv = strtoul(p, &end, 10);
+    unsigned long ov = strtoul(end, NULL, 10);
+    if (cv > 0xFFFF || ov > 0xFFFF || !Servo_SetEndpoints((uint16_t)cv, (uint16_t)ov))
+    {
+      Log_Printf("ERR: DOORCAL %u~%u us (door stopped)\r\n", SERVO_PULSE_US_MIN, SERVO_PULSE_US_MAX);
+      return;
+    }
+    Log_Printf("OK: DOORCAL CLOSED=%lu OPENED=%lu us\r\n", cv, ov);
+    return;
+  }
+
+  if (!strncmp(tmp, "ADVOPEN", 7))
+  {
+    char *p = tmp + 7;
+
+    /* 인자 없으면 현재 기준 거리 출력 (half-step, 0=끔) */
+    while (*p==' ' || *p=='\t') p++;
+    if (*p == 0)
+    {
+      Log_Printf("ADVOPEN %u steps\r\n", Elevator_GetAdvanceOpenSteps());
+      return;
+    }
+
+    unsigned long v = 0;
+    if (strncmp(p, "OFF", 3))
+    {
+      char *end;
+      v = strtoul(p, &end, 10);
+      if (end == p || v > 0xFFFF)
+      {
+        Log_Printf("ERR: ADVOPEN OFF|1~65535\r\n");
+        return;
+      }
+    }
+    Elevator_SetAdvanceOpenSteps((uint16_t)v);
+    Log_Printf("OK: ADVOPEN %lu steps\r\n", v);
+    return;
+  }
+
+  if (!strncmp(tmp, "DOOREASE", 8))
+  {
+    char *p = tmp + 8;
+    while (*p==' ' || *p=='\t') p++;
+
+    servo_ease_t ease;
+    if      (!strncmp(p, "LINEAR", 6))   ease = SERVO_EASE_LINEAR;
+    else if (!strncmp(p, "SMOOTHER", 8)) ease = SERVO_EASE_SMOOTHER;
+    else if (!strncmp(p, "SMOOTH", 6))   ease = SERVO_EASE_SMOOTH;
+    else
+    {
+      Log_Printf("ERR: DOOREASE LINEAR|SMOOTH|SMOOTHER\r\n");
+      return;
+    }
+
+    Servo_SetEasing(ease);   // 다음 문 이동부터 적용
+    Log_Printf("OK: DOOREASE %s\r\n", p);
+    return;
+  }
+
+  if (!strncmp(tmp, "PROFILE", 7))
+  {
+    char *p = tmp + 7;
+    while (*p==' ' || *p=='\t') p++;
+
+    stepper_profile_t mode;
+    if      (!strncmp(p, "CONST", 5))  mode = STEPPER_PROFILE_CONSTANT;
+    else if (!strncmp(p, "TRAP", 4))   mode = STEPPER_PROFILE_TRAPEZOID;
+    else if (!strncmp(p, "SCURVE", 6)) mode = STEPPER_PROFILE_SCURVE;
+    else
+    {
+      Log_Printf("ERR: PROFILE CONST|TRAP|SCURVE\r\n");
+      return;
+    }
+
+    /* 가속 테이블 재계산은 Elevator_Task에서 카 정지(IDLE) 중에: 이동 시작의 테이블 계산과 경쟁 방지 */
+    Elevator_RequestProfileMode(mode);
+    Log_Printf("OK: PROFILE %s (apply when IDLE)\r\n", p);
+    return;
+  }
+
   if (!strncmp(tmp, "CALL", 4))
   {
     char *p = tmp + 4;
@@ -220,6 +536,12 @@ void ResidentUART_Task(void)
 	  /* 층 상태 변화 시 자동 출력 */
   Resident_AutoSendSimpleState();
 
+  if (s_benchRequest)
+  {
+    s_benchRequest = false;
+    RunBench();
+  }
+
   /* 수신 처리 자체는 RxCpltCallback에서 수행 */
 }
 
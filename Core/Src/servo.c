@@ -6,7 +6,8 @@
  *
   *  엘리베이터 문 제어용 서보 모터 제어
  *  - TIM1 CH1 PWM 사용
- *  - HAL_GetTick() 기반 논블로킹 이동
+ *  - HAL_GetTick() 기반 논블로킹 이동 (경과 시간 + 이징 곡선으로 위치 계산)
+ *  - 궤적은 이동 시작 시 버퍼에 미리 계산, TIM1 업데이트 DMA로 PWM 주기에 맞춰 출력
  */
 
 
@@ -19,9 +20,146 @@
  *        내부 상태 변수
  * ============================== */
 static SERVO_STATE servoState;   // 현재 상태
-static uint16_t currentPosition; // 현재 CCR1 값
+static uint16_t currentPosition; // 현재 CCR1 값 (DMA 이동 중에는 Servo_Run이 CCR1에서 읽어 갱신)
 static uint16_t targetPosition;  // 목표 CCR1 값
-static uint32_t prevTime;        // 마지막 이동 시각(ms)
+
+/* 진행 중인 이동: startPosition -> targetPosition을 moveStart부터 moveDuration(ms) 동안 */
+static uint16_t startPosition;
+static uint32_t moveStart;
+static uint32_t moveDuration;
+static servo_ease_t moveEase;
+
+/* 런타임 설정값 (다음 이동부터 반영) */
+static volatile uint16_t openMs  = SERVO_OPEN_MS_DEFAULT;
+static volatile uint16_t closeMs = SERVO_CLOSE_MS_DEFAULT;
+static volatile servo_ease_t easeMode = SERVO_EASE_SMOOTH;
+static uint16_t closedUs = SERVO_CLOSED_US_DEFAULT;   // 닫힘 끝 위치(CCR1 = us)
+static uint16_t openedUs = SERVO_OPENED_US_DEFAULT;   // 열림 끝 위치
+
+/* 끝 위치 보정 요청(UART ISR에서 올 수 있음) -> Servo_Run이 정지 중에 반영 */
+static volatile uint16_t pendClosedUs, pendOpenedUs;
+static volatile bool endpointsPending;
+
+/* 궤적 버퍼: trajBuf[k] = (k+1)번째 PWM 주기부터 적용할 CCR1 값
+ * - CCR1 preload(PWM 모드 기본)라 DMA가 업데이트 이벤트에 쓴 값은 다음 주기부터 반영
+ *   -> 한 주기 안에서 펄스 폭이 바뀌지 않고, main 루프 타이밍과 무관
+ * - 전송 완료 콜백(DMA ISR)은 moveDone만 세우고, 상태 정리는 Servo_Run이 한다
+ */
+static uint16_t trajBuf[SERVO_TRAJ_MAX];
+static bool dmaActive;                 // 이번 이동이 DMA로 진행 중인지 (main 전용)
+static volatile bool moveDone;         // DMA 전송 완료
+static volatile bool dmaError;         // DMA 오류 -> 시간 기반 직접 쓰기로 전환
+
+
+
+/* ==============================
+ *        이징 곡선
+ * ==============================
+ * u, 반환값 모두 Q16 (0 ~ 65536), 정수 연산만 사용
+ */
+#define Q16_ONE  65536
+
+static uint32_t Ease(servo_ease_t e, uint32_t u)
+{
+    int64_t t = (int64_t)u;
+
+    switch (e)
+    {
+        case SERVO_EASE_SMOOTH:
+            /* 3t^2 - 2t^3 = t^2 (3 - 2t) */
+            return (uint32_t)(((t * t >> 16) * (3 * Q16_ONE - 2 * t)) >> 16);
+
+        case SERVO_EASE_SMOOTHER:
+        {
+            /* t^3 (10 + t (6t - 15)) */
+            int64_t t3 = ((t * t >> 16) * t) >> 16;
+            int64_t in = ((t * (6 * t - 15 * Q16_ONE)) >> 16) + 10 * Q16_ONE;
+            return (uint32_t)((t3 * in) >> 16);
+        }
+
+        case SERVO_EASE_LINEAR:
+        default:
+            return u;
+    }
+}
+
+
+/* 진행률 u(Q16)에서의 CCR1 값 */
+static uint16_t PositionAt(uint32_t u)
+{
+    int32_t span = (int32_t)targetPosition - (int32_t)startPosition;
+    return (uint16_t)((int32_t)startPosition + (int32_t)(((int64_t)span * Ease(moveEase, u)) >> 16));
+}
+
+
+/* ==============================
+ *     TIM1 업데이트 DMA 콜백 (ISR)
+ * ============================== */
+static void DmaCplt(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    __HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+    moveDone = true;
+}
+
+static void DmaError(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    __HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+    dmaError = true;
+}
+
+
+/* 진행 중인 DMA 이동 중단: 마지막으로 들어간 CCR1 값을 현재 위치로 삼는다 */
+static void StopDma(void)
+{
+    if (!dmaActive) return;
+
+    __HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+    HAL_DMA_Abort(htim1.hdma[TIM_DMA_ID_UPDATE]);
+    dmaActive = false;
+    currentPosition = (uint16_t)TIM1->CCR1;
+}
+
+
+/* 현재 위치에서 목표까지 새 이동 시작 (전체 스트로크 시간을 남은 거리 비율로 축소) */
+static void StartMotion(uint16_t target, uint16_t strokeMs)
+{
+    StopDma();
+
+    uint32_t dist = (currentPosition > target) ? (currentPosition - target) : (target - currentPosition);
+    uint32_t full = (openedUs > closedUs) ? (openedUs - closedUs) : (closedUs - openedUs);
+
+    startPosition  = currentPosition;
+    targetPosition = target;
+    moveStart      = HAL_GetTick();
+    moveDuration   = (uint32_t)strokeMs * dist / full;
+    if (moveDuration > SERVO_STROKE_MS_MAX) moveDuration = SERVO_STROKE_MS_MAX;   // 끝 위치 보정 이동
+    moveEase       = easeMode;
+    servoState     = SERVO_MOVING;
+
+    if (moveDuration == 0) return;   // 이미 목표 위치: Servo_Run이 바로 정리
+
+    /* PWM 주기 단위 궤적 계산 (마지막 샘플 = 목표) */
+    uint32_t n = (moveDuration + SERVO_FRAME_MS - 1) / SERVO_FRAME_MS;
+    if (n > SERVO_TRAJ_MAX) n = SERVO_TRAJ_MAX;
+
+    for (uint32_t k = 1; k <= n; k++)
+        trajBuf[k - 1] = PositionAt((uint32_t)((k << 16) / n));
+
+    DMA_HandleTypeDef *hdma = htim1.hdma[TIM_DMA_ID_UPDATE];
+    moveDone = false;
+    dmaError = false;
+    hdma->XferCpltCallback  = DmaCplt;
+    hdma->XferErrorCallback = DmaError;
+
+    if (HAL_DMA_Start_IT(hdma, (uint32_t)trajBuf, (uint32_t)&TIM1->CCR1, n) == HAL_OK)
+    {
+        __HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE);
+        dmaActive = true;
+    }
+    /* DMA 시작 실패 시에는 Servo_Run이 경과 시간으로 직접 CCR1을 쓴다 */
+}
 
 
 
@@ -31,9 +169,11 @@ static uint32_t prevTime;        // 마지막 이동 시각(ms)
 void Servo_Init(void)
 {
     servoState = SERVO_STOP;
-    currentPosition = SERVO_LEFT;   // 기본 닫힘(왼쪽)
-    targetPosition  = SERVO_LEFT;
-    prevTime = HAL_GetTick();
+    currentPosition = closedUs;     // 기본 닫힘
+    targetPosition  = closedUs;
+    startPosition   = closedUs;
+    moveStart = HAL_GetTick();
+    moveDuration = 0;
 
     // PWM 출력 초기 위치 적용
     TIM1->CCR1 = currentPosition;
@@ -42,11 +182,16 @@ void Servo_Init(void)
 
 /* ==============================
  *        문 열기 요청
- * ============================== */
+ * ==============================
+ * 매 루프 호출되어도 이미 열림 방향이면 진행 중인 이동을 유지한다.
+ */
 void Servo_Open(void)
 {
-    targetPosition = SERVO_RIGHT;	// 열림 위치 설정
-    servoState = SERVO_MOVING;		// 이동 시작
+    if (targetPosition == openedUs &&
+        (servoState == SERVO_MOVING || currentPosition == openedUs))
+        return;
+
+    StartMotion(openedUs, openMs);	// 열림 위치로 이동 시작
 }
 
 
@@ -55,8 +200,26 @@ void Servo_Open(void)
  * ============================== */
 void Servo_Close(void)
 {
-    targetPosition = SERVO_LEFT;	// 닫힘 위치 설정
-    servoState = SERVO_MOVING;		// 이동 시작
+    if (targetPosition == closedUs &&
+        (servoState == SERVO_MOVING || currentPosition == closedUs))
+        return;
+
+    StartMotion(closedUs, closeMs);	// 닫힘 위치로 이동 시작
+}
+
+
+/* 보정값 반영 (main, 정지 중): 끝 위치에 서 있었으면 같은 쪽의 새 끝 위치로 옮김 */
+static void ApplyEndpoints(void)
+{
+    bool wasClosed = (currentPosition == closedUs);
+    bool wasOpened = (currentPosition == openedUs);
+
+    endpointsPending = false;
+    closedUs = pendClosedUs;
+    openedUs = pendOpenedUs;
+
+    if (wasClosed)      StartMotion(closedUs, closeMs);
+    else if (wasOpened) StartMotion(openedUs, openMs);
 }
 
 
@@ -64,36 +227,118 @@ void Servo_Close(void)
  *     논블로킹 이동 처리 함수
  * ==============================
  * main loop에서 계속 호출해야 함
+ * - DMA 진행 중 : 완료 플래그만 확인
+ * - 그 외(대체) : 위치 = 시작 + (목표 - 시작) * ease(경과 / 이동 시간)
+ *   루프가 늦게 돌아도 이동 시간은 변하지 않고 중간 위치만 건너뛴다.
  */
 void Servo_Run(void)
 {
+    if (endpointsPending && servoState == SERVO_STOP)
+        ApplyEndpoints();
+
     if (servoState == SERVO_STOP)
         return;   // 이미 목표 도달
 
-    // 20ms마다 1단계씩 이동
-    if (HAL_GetTick() - prevTime < 20)
-        return;
+    if (dmaActive)
+    {
+        /* DMA가 이번 주기에 쓴 값 = 현재 펄스 폭 */
+        currentPosition = (uint16_t)TIM1->CCR1;
 
-    prevTime = HAL_GetTick();
+        if (dmaError)
+        {
+            dmaActive = false;   // 같은 궤적을 시간 기반으로 이어서 진행
+        }
+        else
+        {
+            if (!moveDone) return;
 
-    // 목표 위치까지 1씩 증가/감소
-    if (currentPosition < targetPosition)
-        currentPosition++;
-    else if (currentPosition > targetPosition)
-        currentPosition--;
-    else
+            dmaActive = false;
+            currentPosition = targetPosition;
+            servoState = SERVO_STOP;   // 목표 도달
+            return;
+        }
+    }
+
+    uint32_t elapsed = HAL_GetTick() - moveStart;
+    uint16_t pos;
+
+    if (elapsed >= moveDuration)
+    {
+        pos = targetPosition;
         servoState = SERVO_STOP;  // 목표 도달
+    }
+    else
+    {
+        pos = PositionAt((uint32_t)(((uint64_t)elapsed << 16) / moveDuration));
+    }
 
-    // PWM 레지스터 갱신
-    TIM1->CCR1 = currentPosition;
+    // PWM 레지스터 갱신 (값이 바뀔 때만)
+    if (pos != currentPosition)
+    {
+        currentPosition = pos;
+        TIM1->CCR1 = currentPosition;
+    }
+}
+
+
+/* ==============================
+ *     이동 시간 / 이징 설정
+ * ============================== */
+bool Servo_SetStrokeTime(uint16_t open_ms, uint16_t close_ms)
+{
+    if (open_ms  < SERVO_STROKE_MS_MIN || open_ms  > SERVO_STROKE_MS_MAX) return false;
+    if (close_ms < SERVO_STROKE_MS_MIN || close_ms > SERVO_STROKE_MS_MAX) return false;
+
+    openMs  = open_ms;
+    closeMs = close_ms;
+    return true;
+}
+
+void Servo_GetStrokeTime(uint16_t *open_ms, uint16_t *close_ms)
+{
+    if (open_ms)  *open_ms  = openMs;
+    if (close_ms) *close_ms = closeMs;
+}
+
+bool Servo_SetEasing(servo_ease_t ease)
+{
+    if (ease > SERVO_EASE_SMOOTHER) return false;
+    easeMode = ease;
+    return true;
+}
+
+servo_ease_t Servo_GetEasing(void) { return easeMode; }
+
+
+/* ==============================
+ *     끝 위치 보정 (us)
+ * ============================== */
+bool Servo_SetEndpoints(uint16_t closed_us, uint16_t opened_us)
+{
+    if (servoState != SERVO_STOP) return false;
+    if (closed_us < SERVO_PULSE_US_MIN || closed_us > SERVO_PULSE_US_MAX) return false;
+    if (opened_us < SERVO_PULSE_US_MIN || opened_us > SERVO_PULSE_US_MAX) return false;
+    if (closed_us == opened_us) return false;
+
+    pendClosedUs = closed_us;
+    pendOpenedUs = opened_us;
+    endpointsPending = true;
+    return true;
+}
+
+void Servo_GetEndpoints(uint16_t *closed_us, uint16_t *opened_us)
+{
+    if (closed_us) *closed_us = closedUs;
+    if (opened_us) *opened_us = openedUs;
 }
 
 
 /* ==============================
  *       상태 확인 함수
  * ============================== */
-bool Servo_IsOpened(void) { return (currentPosition == SERVO_RIGHT); }
-bool Servo_IsClosed(void) { return (currentPosition == SERVO_LEFT);  }
+/* 끝 위치에 멈춰 있을 때만 참 (이동 시작 직후 CCR1이 아직 출발 끝 값이어도 거짓) */
+bool Servo_IsOpened(void) { return (servoState == SERVO_STOP && currentPosition == openedUs); }
+bool Servo_IsClosed(void) { return (servoState == SERVO_STOP && currentPosition == closedUs); }
 
 
 
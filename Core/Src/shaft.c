@@ -0,0 +1,329 @@
+/*
+ * shaft.c
+ *
+ *  - 포토 상태 변화 시점의 스텝 위치를 기록해 구간별 스텝 수를 학습
+ *  - 이동 중 구간 스텝 수가 허용치를 넘으면 STALL, 너무 짧으면 EARLY
+ *  - 캘리브레이션 주행 중에는 층 구간 경계 위치를 map에 기록(param으로 저장)
+ *  - 보정 후에는 경계를 지날 때마다 Stepper 절대 위치를 map 값으로 맞춤
+ *  - 경계 위치는 포토 에지 타임스탬프(us)로 확정 지연만큼 되돌린 값
+ *  - 모든 함수는 main 컨텍스트에서 호출
+ */
+
+
+#include "shaft.h"
+#include "stepper.h"
+#include "param.h"
+
+
+/* ==============================
+ *        내부 상태 변수
+ * ============================== */
+#define SEG_COUNT  (PF_ERROR + 1)
+
+/* s_expected[구간][방향] : 해당 포토 상태를 통과하는 데 걸린 half-step 수(0=미학습) */
+static uint32_t s_expected[SEG_COUNT][2];
+
+static photo_fsm_t s_seg = PF_UNKNOWN;     // 현재 구간(포토 상태)
+static int32_t  s_segStart = 0;            // 현재 구간 기준 위치
+static bool     s_segFromEdge = false;     // 기준점이 "이동 중 포토 변화"였는지(학습 가능 여부)
+static bool     s_tracking = false;        // 기준점 유효 여부
+static uint8_t  s_dir = DIR_UP;            // 현재 이동 방향
+
+static shaft_fault_t s_fault = SHAFT_FAULT_NONE;
+
+/* 감시 대상 카 모터 */
+static stepper_t *const s_motor = &hstepper1;
+
+/* shaft map: 사용 중인 값(s_map)과 캘리브레이션 기록용(s_cal) */
+static shaft_map_t s_map;
+static shaft_map_t s_cal;
+static bool s_calActive  = false;
+static bool s_referenced = false;   // 절대 위치가 map 좌표계와 맞춰졌는지
+
+
+static inline uint8_t DirIndex(uint8_t dir)
+{
+  return (dir == DIR_UP) ? 0 : 1;
+}
+
+static void ClearMap(shaft_map_t *m)
+{
+  for (uint8_t d = 0; d < 2; d++)
+    for (uint8_t f = 0; f <= SHAFT_FLOORS; f++)
+    {
+      m->lo[d][f] = SHAFT_POS_NONE;
+      m->hi[d][f] = SHAFT_POS_NONE;
+    }
+  m->valid = 0;
+}
+
+/* prev -> now 변화가 map의 어느 경계인지: 해당 칸 포인터(없으면 NULL)
+ * - 층 구간에 들어감 : 위로 가면 lo, 아래로 가면 hi
+ * - 층 구간에서 나감 : 위로 가면 hi, 아래로 가면 lo
+ */
+static int32_t* EdgeSlot(shaft_map_t *m, photo_fsm_t prev, photo_fsm_t now, uint8_t dir)
+{
+  uint8_t d = DirIndex(dir);
+  uint8_t f;
+
+  if ((f = FloorFSM_FloorOf(now)) != 0 && FloorFSM_FloorOf(prev) == 0)
+    return (dir == DIR_UP) ? &m->lo[d][f] : &m->hi[d][f];
+
+  if ((f = FloorFSM_FloorOf(prev)) != 0 && FloorFSM_FloorOf(now) == 0)
+    return (dir == DIR_UP) ? &m->hi[d][f] : &m->lo[d][f];
+
+  return NULL;   // 층->층 직접 변화(센서 이상)나 층 밖 구간끼리는 기록 안함
+}
+
+/* 현재 구간에서 진행한 스텝 수(방향 무관 절댓값) */
+static uint32_t StepsFrom(int32_t pos)
+{
+  int32_t d = pos - s_segStart;
+  return (uint32_t)((d >= 0) ? d : -d);
+}
+
+static uint32_t StepsInSegment(void)
+{
+  return StepsFrom(Stepper_GetPosition(s_motor));
+}
+
+/* 포토 에지 순간의 위치 추정
+ * Photo_Task는 에지 후 글리치 필터 + main 루프 지연 뒤에 상태를 확정하므로,
+ * 그 사이 진행한 스텝을 현재 속도로 계산해 에지 시각의 위치로 되돌린다.
+ * 폴링으로 잡힌 변화처럼 에지 시각을 모르면(너무 오래됨) 현재 위치 그대로.
+ */
+#define EDGE_AGE_MAX_US  20000
+
+static int32_t EdgePosition(void)
+{
+  int32_t  pos = Stepper_GetPosition(s_motor);
+  uint32_t age = Photo_NowUs() - Photo_GetStateUs();
+  if (age > EDGE_AGE_MAX_US) return pos;
+
+  uint32_t sps = Stepper_GetSpeed(s_motor);
+  if (Stepper_GetDriveMode(s_motor) != STEPPER_DRIVE_HALF) sps *= 2;   // half-step 단위로
+
+  int32_t back = (int32_t)((sps * age + 500000U) / 1000000U);
+  return (s_dir == DIR_UP) ? pos - back : pos + back;
+}
+
+
+void Shaft_Init(void)
+{
+  for (uint8_t s = 0; s < SEG_COUNT; s++)
+  {
+    s_expected[s][0] = 0;
+    s_expected[s][1] = 0;
+  }
+
+  s_seg = Photo_GetFSM();
+  s_segStart = Stepper_GetPosition(s_motor);
+  s_segFromEdge = false;
+  s_tracking = false;
+  s_dir = DIR_UP;
+  s_fault = SHAFT_FAULT_NONE;
+
+  /* 저장된 map 복원 (Param_Init 이후 호출) */
+  if (Param_IsValid() && Param_Get()->shaft.valid) s_map = Param_Get()->shaft;
+  else                                             ClearMap(&s_map);
+
+  s_calActive  = false;
+  s_referenced = false;
+}
+
+
+void Shaft_OnMoveStart(uint8_t dir)
+{
+  s_dir = dir;
+  s_seg = Photo_GetFSM();
+  s_segStart = Stepper_GetPosition(s_motor);
+  s_segFromEdge = false;   // 출발 구간은 일부만 지나가므로 학습 제외
+  s_tracking = true;
+}
+
+
+void Shaft_OnPhotoEdge(photo_fsm_t now)
+{
+  bool moving = Stepper_IsBusy(s_motor);
+  int32_t pos = moving ? EdgePosition() : Stepper_GetPosition(s_motor);
+
+  /* 직전 구간을 처음부터 끝까지 이동 중에 지나갔을 때만 평가/학습 */
+  if (s_tracking && s_segFromEdge && moving && s_seg != PF_ERROR)
+  {
+    uint32_t steps = StepsFrom(pos);
+    uint32_t *exp  = &s_expected[s_seg][DirIndex(s_dir)];
+
+    if (*exp && steps + SHAFT_MARGIN_STEPS < (*exp * (100 - SHAFT_TOL_PCT)) / 100)
+    {
+      /* 학습값보다 한참 짧음: 센서 튐 가능성, 학습하지 않음 */
+      if (s_fault == SHAFT_FAULT_NONE) s_fault = SHAFT_FAULT_EARLY;
+    }
+    else if (s_fault == SHAFT_FAULT_NONE)
+    {
+      /* 첫 샘플은 그대로, 이후 1/4 비율 이동평균 */
+      if (*exp == 0) *exp = steps;
+      else           *exp = (uint32_t)((int32_t)*exp + ((int32_t)steps - (int32_t)*exp) / 4);
+    }
+  }
+
+  if (moving)
+  {
+    int32_t *slot;
+
+    /* 캘리브레이션: 경계 위치 기록 */
+    if (s_calActive)
+    {
+      slot = EdgeSlot(&s_cal, s_seg, now, s_dir);
+      if (slot) *slot = pos;
+    }
+    /* 보정 완료: 경계 위치로 절대 위치 재보정 (누적 오차/부팅 직후 원점 보정) */
+    else if (s_map.valid)
+    {
+      slot = EdgeSlot(&s_map, s_seg, now, s_dir);
+      if (slot && *slot != SHAFT_POS_NONE)
+      {
+        Stepper_AdjustPosition(s_motor, *slot - pos);
+        pos = *slot;
+        s_referenced = true;
+      }
+    }
+  }
+
+  /* 새 구간 시작 */
+  s_seg = now;
+  s_segStart = pos;
+  s_segFromEdge = moving;
+  s_tracking = true;
+}
+
+
+void Shaft_Task(void)
+{
+  if (!s_tracking || s_fault != SHAFT_FAULT_NONE) return;
+  if (!Stepper_IsBusy(s_motor) || s_seg == PF_ERROR) return;
+
+  uint32_t exp = s_expected[s_seg][DirIndex(s_dir)];
+  if (exp == 0) return;   // 아직 학습 안된 구간은 MOVE_TIMEOUT에 맡김
+
+  /* 출발 구간(일부만 지남)도 학습값보다 길 수는 없으므로 같은 기준 적용 */
+  if (StepsInSegment() > (exp * (100 + SHAFT_TOL_PCT)) / 100 + SHAFT_MARGIN_STEPS)
+  {
+    s_fault = SHAFT_FAULT_STALL;
+  }
+}
+
+
+shaft_fault_t Shaft_GetFault(void) { return s_fault; }
+
+void Shaft_ClearFault(void)
+{
+  s_fault = SHAFT_FAULT_NONE;
+  s_tracking = false;   // 다음 Shaft_OnMoveStart/포토 변화부터 다시 추적
+}
+
+
+uint32_t Shaft_GetExpectedSteps(photo_fsm_t seg, uint8_t dir)
+{
+  if ((uint32_t)seg >= SEG_COUNT) return 0;
+  return s_expected[seg][DirIndex(dir)];
+}
+
+
+/* ==============================
+ *        캘리브레이션 / 지도
+ * ============================== */
+void Shaft_CalBegin(void)
+{
+  ClearMap(&s_cal);
+  s_calActive = true;
+
+  /* 캘리브레이션 좌표계 = 호출 시점의 위치(호출 측에서 원점 설정) */
+  s_referenced = true;
+}
+
+bool Shaft_CalEnd(bool ok)
+{
+  if (!s_calActive) return false;
+  s_calActive = false;
+  if (!ok) return false;
+
+  /* 주행 범위 안쪽 경계는 양방향 모두 있어야 함 */
+  for (uint8_t d = 0; d < 2; d++)
+  {
+    for (uint8_t f = 1; f <= SHAFT_FLOORS; f++)
+    {
+      if (f > 1 && s_cal.lo[d][f] == SHAFT_POS_NONE) return false;
+      if (f < SHAFT_FLOORS && s_cal.hi[d][f] == SHAFT_POS_NONE) return false;
+    }
+
+    /* 아래에서 위로 순서가 맞는지(센서 배선/방향 오류 검출) */
+    for (uint8_t f = 1; f < SHAFT_FLOORS; f++)
+    {
+      if (s_cal.hi[d][f] >= s_cal.lo[d][f + 1]) return false;
+      if (f > 1 && s_cal.lo[d][f] >= s_cal.hi[d][f]) return false;
+    }
+  }
+
+  s_cal.valid = 1;
+  s_map = s_cal;
+
+  /* FLASH 저장 (모터 정지 상태에서 호출됨) */
+  Param_Get()->shaft = s_map;
+  Param_Save();
+  return true;
+}
+
+bool Shaft_IsCalibrating(void) { return s_calActive; }
+
+const shaft_map_t* Shaft_GetMap(void) { return &s_map; }
+
+bool Shaft_IsReferenced(void) { return s_referenced; }
+
+
+/* UP/DOWN 두 값의 평균(한쪽만 있으면 그 값) */
+static int32_t EdgeAvg(const int32_t e[2][SHAFT_FLOORS + 1], uint8_t f)
+{
+  int32_t a = e[0][f], b = e[1][f];
+  if (a == SHAFT_POS_NONE) return b;
+  if (b == SHAFT_POS_NONE) return a;
+  return a + (b - a) / 2;
+}
+
+bool Shaft_GetFloorCenter(uint8_t floor, int32_t *center)
+{
+  if (!s_map.valid || floor < 1 || floor > SHAFT_FLOORS || !center) return false;
+
+  int32_t lo = EdgeAvg(s_map.lo, floor);
+  int32_t hi = EdgeAvg(s_map.hi, floor);
+
+  if (lo != SHAFT_POS_NONE && hi != SHAFT_POS_NONE)
+  {
+    *center = lo + (hi - lo) / 2;
+    return true;
+  }
+
+  /* 끝 층: 양쪽 경계가 있는 층의 창 폭으로 반대쪽 경계 추정 */
+  int32_t halfWidth = 0;
+  for (uint8_t f = 1; f <= SHAFT_FLOORS; f++)
+  {
+    int32_t l = EdgeAvg(s_map.lo, f), h = EdgeAvg(s_map.hi, f);
+    if (l != SHAFT_POS_NONE && h != SHAFT_POS_NONE) { halfWidth = (h - l) / 2; break; }
+  }
+
+  if (lo != SHAFT_POS_NONE)      *center = lo + halfWidth;
+  else if (hi != SHAFT_POS_NONE) *center = hi - halfWidth;
+  else                           return false;
+  return true;
+}
+
+
+const char* Shaft_FaultToString(shaft_fault_t f)
+{
+  switch (f)
+  {
+    case SHAFT_FAULT_NONE:  return "OK";
+    case SHAFT_FAULT_STALL: return "STALL";
+    case SHAFT_FAULT_EARLY: return "EARLY";
+    default:                return "?";
+  }
+}
@@ -9,6 +9,9 @@
 
 
 #include "stepper.h"
+#include "tim.h"
+#include <math.h>
+#include <string.h>
 
 
 
@@ -17,6 +20,7 @@
  * ==============================
  * 각 행(phase)은 IN1~IN4에 출력할 ON/OFF 상태를 의미한다.
  * 일반적인 28BYJ-48 + ULN2003 조합에서 많이 사용하는 half-step 패턴.
+ * 모든 모터가 같은 표를 쓰고, 핀 배치만 인스턴스마다 다르다.
  */
 static const uint8_t HALF_STEP_SEQ[8][4] =
 {
@@ -33,119 +37,1037 @@ static const uint8_t HALF_STEP_SEQ[8][4] =
 
 
 /* ==============================
- *        내부 상태 변수
- * ============================== */
-static uint8_t  s_stepIndex = 0;			// 현재 phase(0~7)
-static uint32_t s_prevTick  = 0;			// 마지막 스텝 갱신 시각(ms)
-static volatile bool s_busy = false;		// 회전 동작 중 여부
-static volatile uint8_t s_dir = DIR_UP;		// 방향(DIR_UP / DIR_DOWN)
+ *        구동 모드(drive mode)
+ * ==============================
+ * FULL/WAVE 전용 테이블을 따로 두지 않고 위 8-phase 표를 2칸씩 건너뛰며 쓴다.
+ * - HALF : 모든 행, stride 1
+ * - FULL : 홀수 행(코일 2개 ON), stride 2  -> 토크 증가, 같은 sps에서 속도 2배
+ * - WAVE : 짝수 행(코일 1개 ON), stride 2  -> 전류 절감, 같은 sps에서 속도 2배
+ * 위치(position)는 모드와 관계없이 항상 half-step 단위로 유지한다.
+ */
 
 
-/* 스텝 진행 주기(ms)
- * - 값이 작을수록 빠르게 회전하지만 토크 저하/탈조 가능성 증가
- * - 2ms는 꽤 빠른 편이라 부하/전원 상태에 따라 조정 필요
+/* ==============================
+ *        인스턴스 / 채널 라우팅
+ * ==============================
+ * hstepper1 : 카(1번) 모터, 나머지 모터는 사용하는 쪽에서 stepper_t를 잡는다.
+ * s_byCh[i] : TIM4 채널 i(0~3)를 쓰는 모터 (ISR/DMA 콜백에서 인스턴스 찾기용)
+ *
+ * 절대 위치(position)
+ * - ISR에서만 증감, main에서는 읽기(정지 중에만 SetPosition으로 쓰기)
+ * - 32bit 정렬 변수의 load/store는 Cortex-M4에서 단일 명령이라 찢어짐(tearing) 없음
  */
-#define STEP_PERIOD_MS  2
+stepper_t hstepper1;
+
+#define CHOP_CH_IDX  1   // TIM_CHANNEL_2 / 4
+
+static stepper_t *s_byCh[STEPPER_TIM_CHANNELS];
+
+
+/* ==============================
+ *        가감속 테이블
+ * ==============================
+ * ramp[i] : 가속 i번째 스텝 뒤의 스텝 간격(us)
+ * - 모드(사다리꼴/S-curve)에 따라 설정 변경 시(main 컨텍스트) 한 번만 계산
+ * - ISR은 인덱스로 읽기만 한다 (나눗셈/제곱근 없음)
+ * - 감속은 같은 테이블을 남은 스텝 수로 거꾸로 읽는다
+ *
+ * 스텝 간격이 짧을수록 빠르게 회전하지만 토크 저하/탈조 가능성 증가
+ *
+ * 비상 감속(EMG)
+ * - 가속 테이블 인덱스를 스텝마다 STEPPER_EMG_DECEL_MULT씩 줄이며 감속(가속도의 배수)
+ * - 허용 스텝(emgLeft)을 다 쓰면 남은 속도와 상관없이 그 자리에서 정지
+ */
+
+/* 테이블 생성부(아래쪽)에 정의, StartMove에서 방향별 재계산에 사용 */
+static uint16_t EffectiveCruise(stepper_t *m, uint8_t dir);
+static void RebuildRampFor(stepper_t *m, uint16_t cruise);
+
+
+/* ==============================
+ *   phase별 BSRR 출력 워드
+ * ==============================
+ * IN1~IN4가 여러 포트에 흩어져 있을 수 있으므로 포트별로
+ * "SET 비트 | (RESET 비트 << 16)" 워드를 미리 만들어 둔다.
+ * 한 스텝 출력 = 포트 수(최대 4)만큼의 BSRR store, 분기/assert 없음.
+ */
+static void BuildPhaseBsrr(stepper_t *m)
+{
+  GPIO_TypeDef *const *port = m->hw.port;
+  const uint16_t      *pin  = m->hw.pin;
+
+  /* 사용 포트 목록(중복 제거) */
+  m->portCount = 0;
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    uint8_t p;
+    for (p = 0; p < m->portCount; p++)
+      if (m->ports[p] == port[i]) break;
+    if (p == m->portCount) m->ports[m->portCount++] = port[i];
+  }
+
+  /* 코일 전체 OFF 워드 */
+  for (uint8_t p = 0; p < m->portCount; p++)
+  {
+    m->offBsrr[p] = 0;
+    for (uint8_t i = 0; i < 4; i++)
+      if (port[i] == m->ports[p]) m->offBsrr[p] |= (uint32_t)pin[i] << 16;
+  }
+
+  /* phase x 포트별 BSRR 워드 */
+  for (uint8_t ph = 0; ph < 8; ph++)
+  {
+    for (uint8_t p = 0; p < m->portCount; p++)
+    {
+      uint32_t word = 0;
+      for (uint8_t i = 0; i < 4; i++)
+      {
+        if (port[i] != m->ports[p]) continue;
+        word |= HALF_STEP_SEQ[ph][i] ? (uint32_t)pin[i] : ((uint32_t)pin[i] << 16);
+      }
+      m->phaseBsrr[ph][p] = word;
+    }
+  }
+}
 
 
 /* ==============================
  *   특정 phase를 GPIO에 출력
  * ============================== */
-static void Stepper_WritePhase(uint8_t phase)
+static inline void Stepper_WritePhase(stepper_t *m, uint8_t phase)
+{
+  const uint32_t *w = m->phaseBsrr[phase];
+  for (uint8_t p = 0; p < m->portCount; p++)
+    m->ports[p]->BSRR = w[p];
+}
+
+
+static inline void Stepper_WriteOff(stepper_t *m)
+{
+  for (uint8_t p = 0; p < m->portCount; p++)
+    m->ports[p]->BSRR = m->offBsrr[p];
+}
+
+
+/* 기존 방식(HAL_GPIO_WritePin x4): 벤치마크 비교용으로만 남겨 둠 */
+static void Stepper_WritePhaseHal(stepper_t *m, uint8_t phase)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    HAL_GPIO_WritePin(m->hw.port[i], m->hw.pin[i], HALF_STEP_SEQ[phase][i] ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+
+/* ==============================
+ *     코일 전원 상태(power state)
+ * ==============================
+ * RUN     : 회전 중 (ISR이 phase 출력)
+ * HOLD    : 정지 직후 전류 100% 홀드, STEPPER_HOLD_SETTLE_MS 유지
+ * REDUCED : TIM4 CH2 비교 인터럽트로 phase <-> OFF를 잘게 반복(초핑)해
+ *           평균 전류를 STEPPER_CHOP_ON_US / STEPPER_CHOP_PERIOD_US로 낮춤
+ * OFF     : 주차(IDLE + 문 닫힘) 상태면 코일 완전 OFF
+ *
+ * 초핑 채널(CH2)은 모든 모터가 공유한다. REDUCED 모터가 하나라도 있으면 돌고,
+ * 모두 같은 ON/OFF 위상으로 출력된다.
+ *
+ * stepIndex는 어떤 상태에서도 바꾸지 않으므로, 다음 이동 시작 전에
+ * 같은 phase를 다시 출력하면 위치 손실 없이 이어서 구동된다.
+ */
+static volatile bool    s_chopOn    = false;	// 현재 코일 ON 구간인지(공용)
+static volatile uint8_t s_chopUsers = 0;		// REDUCED 상태인 모터 수
+
+
+static void EnterPower(stepper_t *m, stepper_power_t st)
 {
-  HAL_GPIO_WritePin(IN1_PORT, IN1_PIN, HALF_STEP_SEQ[phase][0] ? GPIO_PIN_SET : GPIO_PIN_RESET);
-  HAL_GPIO_WritePin(IN2_PORT, IN2_PIN, HALF_STEP_SEQ[phase][1] ? GPIO_PIN_SET : GPIO_PIN_RESET);
-  HAL_GPIO_WritePin(IN3_PORT, IN3_PIN, HALF_STEP_SEQ[phase][2] ? GPIO_PIN_SET : GPIO_PIN_RESET);
-  HAL_GPIO_WritePin(IN4_PORT, IN4_PIN, HALF_STEP_SEQ[phase][3] ? GPIO_PIN_SET : GPIO_PIN_RESET);
+  /* 초핑에서 빠짐: 마지막 사용자면 CH2 중지 (ISR이 도중에 다시 쓰지 않도록 먼저 끔) */
+  if (m->power == STEPPER_POWER_REDUCED && st != STEPPER_POWER_REDUCED)
+  {
+    if (s_chopUsers && --s_chopUsers == 0)
+      HAL_TIM_OC_Stop_IT(&htim4, TIM_CHANNEL_2);
+  }
+
+  switch (st)
+  {
+    case STEPPER_POWER_OFF:
+      Stepper_WriteOff(m);
+      break;
+
+    case STEPPER_POWER_REDUCED:
+      if (m->power == STEPPER_POWER_REDUCED) break;
+      if (s_chopUsers++ == 0)
+      {
+        s_chopOn = true;
+        __HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_2,
+                              (uint16_t)(__HAL_TIM_GET_COUNTER(&htim4) + STEPPER_CHOP_ON_US));
+        HAL_TIM_OC_Start_IT(&htim4, TIM_CHANNEL_2);
+      }
+      /* 이미 돌고 있는 초핑 위상에 맞춰 출력 */
+      if (s_chopOn) Stepper_WritePhase(m, m->stepIndex);
+      else          Stepper_WriteOff(m);
+      break;
+
+    case STEPPER_POWER_RUN:
+    case STEPPER_POWER_HOLD:
+    default:
+      Stepper_WritePhase(m, m->stepIndex);   // 마지막 phase 그대로 복원
+      break;
+  }
+
+  m->power = st;
+  m->powerTick = HAL_GetTick();
+}
+
+/* 현재 상태의 추정 소비 전력(mW) */
+static uint32_t PowerMw(stepper_t *m)
+{
+  /* half-step 표: 짝수 행 코일 1개, 홀수 행 코일 2개 */
+  uint32_t holdCoils = (m->stepIndex & 1U) ? 2 : 1;
+
+  switch (m->power)
+  {
+    case STEPPER_POWER_RUN:
+      /* 평균 코일 수: HALF 1.5, FULL 2, WAVE 1 */
+      if (m->driveMode == STEPPER_DRIVE_FULL) return 2 * STEPPER_COIL_MW;
+      if (m->driveMode == STEPPER_DRIVE_WAVE) return STEPPER_COIL_MW;
+      return 3 * STEPPER_COIL_MW / 2;
+    case STEPPER_POWER_HOLD:
+      return holdCoils * STEPPER_COIL_MW;
+    case STEPPER_POWER_REDUCED:
+      return holdCoils * STEPPER_COIL_MW * STEPPER_CHOP_ON_US / STEPPER_CHOP_PERIOD_US;
+    case STEPPER_POWER_OFF:
+    default:
+      return 0;
+  }
 }
 
 
 /* ==============================
  *          초기화
  * ============================== */
-void Stepper_Init(void)
+bool Stepper_Init(stepper_t *m, const stepper_hw_t *hw)
 {
-  s_stepIndex = 0;
-  s_prevTick = HAL_GetTick();
-  s_busy = false;
-  s_dir = DIR_UP;
+  if (!m || !hw) return false;
+
+  uint32_t ch = hw->channel / 4U;   // TIM_CHANNEL_1/2/3/4 = 0x0/0x4/0x8/0xC
+  if (ch >= STEPPER_TIM_CHANNELS || ch == CHOP_CH_IDX) return false;
+  if (s_byCh[ch] && s_byCh[ch] != m) return false;
+
+  memset(m, 0, sizeof(*m));
+  m->hw = *hw;
+  m->chIdx = (uint8_t)ch;
+
+  m->dir = DIR_UP;
+  m->driveMode = STEPPER_DRIVE_HALF;
+  m->stride = 1;
+  BuildPhaseBsrr(m);
+  m->profileMode = STEPPER_PROFILE_TRAPEZOID;
+  m->jerk = STEPPER_JERK_DEFAULT;
+
+  Stepper_SetProfile(m, STEPPER_START_SPS_DEFAULT, STEPPER_CRUISE_SPS_DEFAULT, STEPPER_ACCEL_DEFAULT);
 
   /* 초기 phase 출력
-   * - 여기서는 phase 0을 출력하여 코일을 "일부 ON" 상태로 둘 수 있음(홀드)
-   * - 완전 OFF를 원하면 아래 대신 모든 핀 RESET 처리 필요
+   * - phase 0을 출력하여 코일을 "일부 ON" 상태로 둠(홀드)
+   * - 이후 Stepper_Task가 시간에 따라 감전류 홀드/OFF로 전환
    */
-  Stepper_WritePhase(0);
+  Stepper_WritePhase(m, 0);
+  m->power = STEPPER_POWER_HOLD;
+  m->powerTick = m->pwrLastTick = HAL_GetTick();
+
+  s_byCh[ch] = m;
+  return true;
 }
 
 
 
 
 /* ==============================
- *       연속 회전 시작
+ *   스텝 간격 계산 (ISR / DMA 콜백)
+ * ==============================
+ * done 스텝을 진행한 뒤 다음 스텝까지의 간격(us)
+ * 가속 인덱스 = 진행한 스텝 수, 감속 인덱스 = 남은 스텝 수 - 1
+ * 둘 중 작은 값으로 테이블을 읽으면 가속/등속/감속이 모두 표현된다.
+ */
+static inline uint16_t IntervalAt(const stepper_t *m, uint32_t done)
+{
+	uint32_t i = done;
+
+	if (m->stepsTotal)
+	{
+		/* 목표 이후: 크립(START 속도) 또는 DMA 선계획이 끝을 넘어간 경우 */
+		if (done >= m->stepsTotal) return m->creepAfter ? m->startUs : m->cruiseUs;
+		uint32_t remain = m->stepsTotal - done;          // 1 이상
+		if (remain - 1 < i) i = remain - 1;
+	}
+
+	return (i < m->rampLen) ? m->ramp[i] : m->cruiseUs;
+}
+
+
+/* TIM4 비교 레지스터 접근 (CCR1~CCR4는 연속 배치) */
+static inline volatile uint32_t* Ccr(const stepper_t *m)
+{
+	return &htim4.Instance->CCR1 + m->chIdx;
+}
+
+
+/* ==============================
+ *   DMA 스텝 타이밍 시퀀서
+ * ==============================
+ * TIM4 비교 일치마다 DMA가 dmaBuf의 다음 값을 그 채널의 CCR에 써 넣는다.
+ * 버퍼에는 "다음 스텝의 절대 시각"이 미리 들어 있으므로
+ * 스텝 ISR은 간격 계산/CCR 갱신 없이 phase 출력만 한다.
+ * - 순환(circular) 버퍼, 절반/전체 전송 완료 콜백에서 지난 절반을 다시 채움
+ * - 등속 구간에서는 콜백이 STEPPER_DMA_BUF/2 스텝마다 한 번만 돈다
+ * - 현재 DMA 스트림이 연결된 채널은 CH1(DMA1 Stream0 CH2)뿐
+ *
+ * 참고: F411에서 GPIO(AHB1)에 쓸 수 있는 DMA2는 TIM1(도어 서보)만 트리거로
+ * 받을 수 있고 코일이 3개 포트에 나뉘어 있어, BSRR 자체를 DMA로 쓰는 대신
+ * 스텝 타이밍을 DMA로 순서화한다.
+ */
+static inline DMA_HandleTypeDef* StepDma(const stepper_t *m)
+{
+	return htim4.hdma[TIM_DMA_ID_CC1 + m->chIdx];
+}
+
+static void FillDma(stepper_t *m, uint16_t from, uint16_t count)
+{
+	for (uint16_t k = 0; k < count; k++)
+	{
+		m->planTime = (uint16_t)(m->planTime + IntervalAt(m, m->planStep));
+		m->planStep++;
+		m->dmaBuf[from + k] = m->planTime;
+	}
+}
+
+/* DMA 핸들 -> 인스턴스 */
+static stepper_t* DmaOwner(DMA_HandleTypeDef *hdma)
+{
+	for (uint8_t i = 0; i < STEPPER_TIM_CHANNELS; i++)
+		if (s_byCh[i] && s_byCh[i]->dmaActive && StepDma(s_byCh[i]) == hdma) return s_byCh[i];
+	return NULL;
+}
+
+static void DmaHalfCplt(DMA_HandleTypeDef *hdma)
+{
+	stepper_t *m = DmaOwner(hdma);
+	if (m) FillDma(m, 0, STEPPER_DMA_BUF / 2);
+}
+
+static void DmaCplt(DMA_HandleTypeDef *hdma)
+{
+	stepper_t *m = DmaOwner(hdma);
+	if (m) FillDma(m, STEPPER_DMA_BUF / 2, STEPPER_DMA_BUF / 2);
+}
+
+
+/* EMG 감속 종료: 정지 거리 기록 (ISR/main 공통) */
+static void EndEmg(stepper_t *m)
+{
+	if (!m->emgActive) return;
+	m->emgActive = false;
+
+	int32_t d = m->position - m->emgStartPos;
+	m->emgSteps = (uint32_t)((d >= 0) ? d : -d);
+}
+
+
+/* DMA 순서화 해제 (CCR에 들어간 다음 시각은 그대로 남음) */
+static void StopDma(stepper_t *m)
+{
+	if (!m->dmaActive) return;
+
+	__HAL_TIM_DISABLE_DMA(&htim4, TIM_DMA_CC1 << m->chIdx);
+	HAL_DMA_Abort_IT(StepDma(m));
+	m->dmaActive = false;
+}
+
+
+/* 스텝 타이머 정지 (두 모드 공통, ISR에서도 호출) */
+static void StopTimer(stepper_t *m)
+{
+	HAL_TIM_OC_Stop_IT(&htim4, m->hw.channel);
+	StopDma(m);
+}
+
+
+/* 이동 시작 공통 처리 (steps=0이면 연속 회전, creep이면 목표 후 START 속도로 계속) */
+static void StartMove(stepper_t *m, uint8_t dir, uint32_t steps, bool creep)
+{
+	/* 이미 회전 중이면 방향만 바꾸고 타이머는 그대로 둔다 */
+	m->dir = dir;
+	if (m->busy) return;
+
+	/* 방향별 CRUISE가 현재 테이블과 다르면 이 방향용으로 재계산 (수백 us) */
+	uint16_t cruise = EffectiveCruise(m, dir);
+	if (cruise != m->builtCruise) RebuildRampFor(m, cruise);
+
+	/* 감전류/OFF 상태였다면 같은 phase를 다시 100%로 출력한 뒤 출발 */
+	if (m->power != STEPPER_POWER_RUN) EnterPower(m, STEPPER_POWER_RUN);
+
+	m->stepsDone = 0;
+	m->stepsTotal = steps;
+	m->creepAfter = creep;
+	m->busy = true;
+
+	/* 첫 간격(START 속도) 뒤에 첫 스텝이 나오도록 비교값 예약 */
+	uint16_t first = (uint16_t)(__HAL_TIM_GET_COUNTER(&htim4) + IntervalAt(m, 0));
+	*Ccr(m) = first;
+
+	if (m->dmaMode)
+	{
+		/* 1번 스텝 시각부터 버퍼 전체를 미리 계획 */
+		m->planStep = 1;
+		m->planTime = first;
+		FillDma(m, 0, STEPPER_DMA_BUF);
+
+		DMA_HandleTypeDef *hdma = StepDma(m);
+		hdma->XferHalfCpltCallback = DmaHalfCplt;
+		hdma->XferCpltCallback     = DmaCplt;
+		hdma->XferErrorCallback    = NULL;
+
+		if (HAL_DMA_Start_IT(hdma, (uint32_t)m->dmaBuf, (uint32_t)Ccr(m),
+		                     STEPPER_DMA_BUF) == HAL_OK)
+		{
+			__HAL_TIM_ENABLE_DMA(&htim4, TIM_DMA_CC1 << m->chIdx);
+			m->dmaActive = true;
+		}
+		/* DMA 시작 실패 시에는 ISR 방식으로 그대로 진행 */
+	}
+
+	HAL_TIM_OC_Start_IT(&htim4, m->hw.channel);
+}
+
+
+/* ==============================
+ *     DMA 타이밍 모드 선택
  * ============================== */
-void Stepper_StartContinuous(uint8_t dir)
+bool Stepper_SetDmaMode(stepper_t *m, bool enable)
+{
+	if (m->busy) return false;
+	if (enable && StepDma(m) == NULL) return false;   // 이 채널엔 DMA 스트림 없음
+	m->dmaMode = enable;
+	return true;
+}
+
+bool Stepper_GetDmaMode(stepper_t *m) { return m->dmaMode; }
+
+
+/* half-step 거리 -> 현재 모드의 모터 스텝 수 (FULL/WAVE는 반올림, 세 이동 API 공통) */
+static inline uint32_t HalfToSteps(const stepper_t *m, uint32_t half)
 {
+	return (half + m->stride / 2) / m->stride;
+}
+
 
+/* ==============================
+ *       연속 회전 시작
+ * ============================== */
+void Stepper_StartContinuous(stepper_t *m, uint8_t dir)
+{
 	/* dir 값은 DIR_UP / DIR_DOWN 사용 권장 */
-	s_dir = dir;
-	s_busy = true;
+	StartMove(m, dir, 0, false);
+}
+
+
+/* ==============================
+ *    지정 스텝 프로파일 이동
+ * ============================== */
+void Stepper_MoveProfile(stepper_t *m, uint8_t dir, uint32_t steps)
+{
+	/* half-step 단위 -> 현재 모드의 모터 스텝 수 */
+	steps = HalfToSteps(m, steps);
+	if (steps == 0) return;
+	StartMove(m, dir, steps, false);
+}
+
+
+/* ==============================
+ *     절대 위치로 이동 / 위치
+ * ============================== */
+bool Stepper_MoveTo(stepper_t *m, int32_t target_steps)
+{
+	/* 이동 중 재계획은 지원하지 않음(감속 구간이 꼬임) */
+	if (m->busy) return false;
+
+	int32_t delta = target_steps - m->position;
+	if (delta == 0) return true;
+
+	/* FULL/WAVE에서는 2 half-step 단위로 반올림 (홀수 차이는 1 half-step 지나침) */
+	uint8_t  dir = (delta > 0) ? DIR_UP : DIR_DOWN;
+	uint32_t mag = (delta > 0) ? (uint32_t)delta : (uint32_t)(-delta);
+	uint32_t steps = HalfToSteps(m, mag);
+
+	if (steps) StartMove(m, dir, steps, false);
+	return true;
+}
+
+bool Stepper_MoveToCreep(stepper_t *m, int32_t target_steps, uint8_t dir)
+{
+	if (m->busy) return false;
+
+	/* 목표가 이미 진행 방향 뒤쪽이면 바로 크립 (최소 1스텝 계획) */
+	int32_t delta = target_steps - m->position;
+	if (dir == DIR_DOWN) delta = -delta;
+
+	uint32_t steps = (delta > 0) ? HalfToSteps(m, (uint32_t)delta) : 0;
+	if (steps == 0) steps = 1;
+
+	StartMove(m, dir, steps, true);
+	return true;
+}
+
+int32_t Stepper_GetPosition(stepper_t *m) { return m->position; }
+
+void Stepper_SetPosition(stepper_t *m, int32_t pos)
+{
+	/* 회전 중에는 ISR과 경쟁하므로 무시 */
+	if (m->busy) return;
+	m->position = pos;
+}
+
+void Stepper_AdjustPosition(stepper_t *m, int32_t delta)
+{
+	/* 회전 중에도 허용: read-modify-write 동안만 인터럽트 차단 */
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	m->position += delta;
+	__set_PRIMASK(primask);
+}
+
+
+/* ==============================
+ *  사다리꼴 가속 테이블 생성
+ * ==============================
+ * v_i = sqrt(v0^2 + 2*a*i),  간격 = 1e6 / v_i
+ * 설정 시 1회만 계산하므로 float(FPU) 사용
+ */
+static uint16_t BuildTrapezoid(stepper_t *m)
+{
+	float v0sq = (float)m->startSps * (float)m->startSps;
+	float twoA = 2.0f * (float)m->accel;
+	uint16_t n = 0;
+
+	while (n < STEPPER_RAMP_MAX)
+	{
+		float v = sqrtf(v0sq + twoA * (float)n);
+		if (v >= (float)m->builtCruise) break;
+		m->ramp[n++] = (uint16_t)(1000000.0f / v + 0.5f);
+	}
+	return n;
+}
+
+
+/* ==============================
+ *  S-curve(저크 제한) 가속 테이블 생성
+ * ==============================
+ * 가속도를 JERK 기울기로 0 -> ACCEL까지 올리고, 목표 속도에 가까워지면
+ * 다시 0까지 내려서 속도 곡선의 양 끝을 둥글게 만든다.
+ *   - 가속도 하강 시작 조건: a^2 >= 2*J*(v_cruise - v)
+ *
+ * 스텝 단위로 적분하며 고정소수점만 사용한다. 나눗셈은 첫 간격 1회뿐이고
+ * 이후 간격(=1/v)은 직전 간격에서 Newton-Raphson(c' = c*(2 - v*c))으로 갱신.
+ * (저속에서 한 스텝에 속도가 크게 뛰면 v*c >= 2가 되어 발산하므로 c를 먼저 반으로 줄임)
+ *   v : Q16 sps,  a : Q16 sps/s,  c : Q8 us
+ *   1e6 나눗셈은 SCURVE_K = 2^32/1e6 곱셈 + 시프트로 대체
+ */
+#define SCURVE_K  4295ULL   // round(2^32 / 1e6)
+
+static uint16_t BuildSCurve(stepper_t *m)
+{
+	uint64_t vCruise = (uint64_t)m->builtCruise << 16;
+	uint64_t aMax    = (uint64_t)m->accel << 16;
+	uint64_t v = (uint64_t)m->startSps << 16;
+	uint64_t a = 0;
+	uint64_t c = ((1000000ULL << 8) + m->startSps / 2) / m->startSps;
+	bool ramping_down = false;
+	uint16_t n = 0;
+
+	while (n < STEPPER_RAMP_MAX && v < vCruise)
+	{
+		m->ramp[n++] = (uint16_t)((c + 128) >> 8);
+
+		/* 이번 스텝 동안의 가속도 변화: da = J * dt */
+		uint64_t da = ((uint64_t)m->jerk * c * SCURVE_K) >> 24;
+
+		if (!ramping_down)
+		{
+			uint64_t aInt = a >> 16;
+			uint64_t need = (vCruise - v) >> 16;
+			if (aInt * aInt >= 2ULL * m->jerk * need) ramping_down = true;
+		}
+
+		if (ramping_down) a = (a > da) ? (a - da) : 0;
+		else              a = (a + da > aMax) ? aMax : (a + da);
+
+		/* 가속도가 0까지 내려왔는데 목표 속도 직전이면 남은 차이는 등속으로 흡수 */
+		if (ramping_down && a == 0) break;
+
+		/* 속도 적분: dv = a * dt */
+		v += (((a * c) >> 8) * SCURVE_K) >> 32;
+
+		/* 간격 갱신: c' = c * (2 - v*c/1e6) */
+		for (uint8_t it = 0; it < 3; it++)
+		{
+			uint64_t vc = (v * c) >> 24;             // 수렴 시 ~1e6
+			if (vc >= 2000000ULL) { c >>= 1; continue; }
+			c = (c * (((2000000ULL - vc) * SCURVE_K) >> 8)) >> 24;   // (2 - v*c)는 Q24
+		}
+	}
+	return n;
+}
+
+
+/* 방향별 실제 CRUISE: 방향 설정값이 있으면 우선, START~STEP_PERIOD_US_MIN 한도로 제한 */
+static uint16_t EffectiveCruise(stepper_t *m, uint8_t dir)
+{
+	uint16_t sps = m->dirCruise[(dir == DIR_UP) ? 0 : 1];
+	if (sps == 0) sps = m->cruiseSps;
+	if (sps < m->startSps) sps = m->startSps;
+	if (sps > 1000000UL / STEP_PERIOD_US_MIN) sps = (uint16_t)(1000000UL / STEP_PERIOD_US_MIN);
+	return sps;
+}
+
+
+/* ==============================
+ *   현재 모드로 가속 테이블 재계산
+ * ==============================
+ * 테이블은 한 번에 한 CRUISE용만 유지한다(builtCruise).
+ * 방향별 CRUISE가 다르면 이동 시작 시(정지 상태) 그 방향용으로 다시 만든다.
+ */
+static void RebuildRampFor(stepper_t *m, uint16_t cruise)
+{
+	uint16_t n = 0;
+
+	m->builtCruise = cruise;
+
+	switch (m->profileMode)
+	{
+		case STEPPER_PROFILE_TRAPEZOID: n = BuildTrapezoid(m); break;
+		case STEPPER_PROFILE_SCURVE:    n = BuildSCurve(m);    break;
+		case STEPPER_PROFILE_CONSTANT:
+		default:                        n = 0;                 break;
+	}
+
+	m->rampLen = n;
+
+	m->startUs = (uint16_t)((1000000UL + m->startSps / 2) / m->startSps);
+
+	/* 등속(기존) 모드: 가감속 없이 START 속도로만 회전 */
+	if (m->profileMode == STEPPER_PROFILE_CONSTANT)
+		m->cruiseUs = m->startUs;
+	/* 테이블이 가득 차면 마지막 간격을 등속으로 사용(CRUISE 하향 보정) */
+	else if (n == STEPPER_RAMP_MAX)
+		m->cruiseUs = m->ramp[n - 1];
+	else
+		m->cruiseUs = (uint16_t)((1000000UL + cruise / 2) / cruise);
+}
+
+static void RebuildRamp(stepper_t *m)
+{
+	RebuildRampFor(m, EffectiveCruise(m, m->dir));
+}
+
+
+/* ==============================
+ *     가감속 프로파일 설정
+ * ============================== */
+bool Stepper_SetProfile(stepper_t *m, uint16_t start_sps, uint16_t cruise_sps, uint16_t accel_sps2)
+{
+	/* ISR이 테이블을 읽는 중에는 다시 만들지 않는다 */
+	if (m->busy) return false;
+	if (start_sps < STEPPER_START_SPS_MIN || cruise_sps < start_sps || accel_sps2 == 0) return false;
+
+	/* 스텝 간격 하한(STEP_PERIOD_US_MIN)을 넘는 속도는 잘라낸다 */
+	if (cruise_sps > 1000000UL / STEP_PERIOD_US_MIN) cruise_sps = 1000000UL / STEP_PERIOD_US_MIN;
+
+	m->startSps  = start_sps;
+	m->cruiseSps = cruise_sps;
+	m->accel     = accel_sps2;
+	RebuildRamp(m);
+	return true;
+}
+
+
+void Stepper_GetProfile(stepper_t *m, uint16_t *start_sps, uint16_t *cruise_sps, uint16_t *accel_sps2)
+{
+	if (start_sps)  *start_sps  = m->startSps;
+	if (cruise_sps) *cruise_sps = m->cruiseSps;
+	if (accel_sps2) *accel_sps2 = m->accel;
 }
 
 
+/* ==============================
+ *      방향별 CRUISE 설정
+ * ============================== */
+bool Stepper_SetDirCruise(stepper_t *m, uint8_t dir, uint16_t cruise_sps)
+{
+	if (m->busy) return false;
+	m->dirCruise[(dir == DIR_UP) ? 0 : 1] = cruise_sps;
+	return true;
+}
+
+uint16_t Stepper_GetDirCruise(stepper_t *m, uint8_t dir) { return EffectiveCruise(m, dir); }
+
+
+/* ==============================
+ *        저크 설정 (S-curve)
+ * ============================== */
+bool Stepper_SetJerk(stepper_t *m, uint32_t jerk_sps3)
+{
+	if (m->busy || jerk_sps3 == 0) return false;
+
+	m->jerk = jerk_sps3;
+	RebuildRamp(m);
+	return true;
+}
+
+
+/* ==============================
+ *      프로파일 모드 선택
+ * ============================== */
+bool Stepper_SetProfileMode(stepper_t *m, stepper_profile_t mode)
+{
+	if (m->busy || mode > STEPPER_PROFILE_SCURVE) return false;
+
+	m->profileMode = mode;
+	RebuildRamp(m);
+	return true;
+}
+
+stepper_profile_t Stepper_GetProfileMode(stepper_t *m) { return m->profileMode; }
+
+
+/* ==============================
+ *        구동 모드 선택
+ * ==============================
+ * 현재 phase가 새 모드의 행(FULL=홀수, WAVE=짝수)이 아니면 한 half-step
+ * 위(DIR_UP)로 옮겨 맞춘다. 실제로 회전자가 움직이므로 위치도 같이 갱신.
+ */
+bool Stepper_SetDriveMode(stepper_t *m, stepper_drive_t mode)
+{
+	if (m->busy || mode > STEPPER_DRIVE_WAVE) return false;
+
+	m->driveMode = mode;
+	m->stride = (mode == STEPPER_DRIVE_HALF) ? 1 : 2;
+
+	bool needOdd = (mode == STEPPER_DRIVE_FULL);
+	if (mode != STEPPER_DRIVE_HALF && ((m->stepIndex & 1U) != needOdd))
+	{
+		m->stepIndex = (m->stepIndex + 1) & 0x07;
+		m->position += 1;
+		EnterPower(m, STEPPER_POWER_HOLD);   // 새 phase를 100%로 출력, 홀드 타이머 재시작
+	}
+	return true;
+}
+
+stepper_drive_t Stepper_GetDriveMode(stepper_t *m) { return m->driveMode; }
+
+
 /* ==============================
  *           정지
  * ============================== */
-void Stepper_Stop(void)
+void Stepper_Stop(stepper_t *m)
 {
-  s_busy = false;
+  /* 타이머 인터럽트(및 DMA)만 끄면 ISR이 더 이상 phase를 바꾸지 않는다 */
+  StopTimer(m);
+  m->busy = false;
+  EndEmg(m);
 
 
-  /* 주의: phase 0 출력은 "완전 OFF"가 아니라 0번 상으로 고정됨
-   * - 홀드(토크 유지) 의도면 OK
-   * - 코일 OFF(발열 감소/전력 절감) 의도면 아래 대신 모두 RESET 해야 함
+  /* 마지막으로 출력한 phase를 그대로 유지(홀드)한다.
+   * - 예전처럼 phase 0을 쓰면 최대 반 스텝 튀면서 절대 위치가 어긋남
+   * - 감전류 홀드/코일 OFF 전환은 Stepper_Task가 시간에 따라 처리
    */
+}
 
 
-  Stepper_WritePhase(0);
-  /* (완전 OFF가 필요하면 예시)
-   * HAL_GPIO_WritePin(IN1_PORT, IN1_PIN, GPIO_PIN_RESET);
-   * HAL_GPIO_WritePin(IN2_PORT, IN2_PIN, GPIO_PIN_RESET);
-   * HAL_GPIO_WritePin(IN3_PORT, IN3_PIN, GPIO_PIN_RESET);
-   * HAL_GPIO_WritePin(IN4_PORT, IN4_PIN, GPIO_PIN_RESET);
-   */
+/* ==============================
+ *    코일 전원 관리 Task (main)
+ * ============================== */
+void Stepper_Task(stepper_t *m)
+{
+  uint32_t now = HAL_GetTick();
+  uint32_t dt  = now - m->pwrLastTick;
+  m->pwrLastTick = now;
+
+  /* 직전 구간을 현재 상태에 누적 */
+  m->pwrMs[m->power] += dt;
+  m->pwrUj[m->power] += (uint64_t)PowerMw(m) * dt;
+
+  if (m->busy)
+  {
+    m->power = STEPPER_POWER_RUN;   // StartMove에서 이미 RUN, ISR 정지 대비용
+    return;
+  }
+
+  /* 정지 감지(Stop 또는 ISR에서 이동 완료) -> 100% 홀드부터 */
+  if (m->power == STEPPER_POWER_RUN)
+  {
+    EnterPower(m, STEPPER_POWER_HOLD);
+    return;
+  }
+
+  uint32_t inState = now - m->powerTick;
+
+  switch (m->power)
+  {
+    case STEPPER_POWER_HOLD:
+      if (inState >= STEPPER_HOLD_SETTLE_MS)
+        EnterPower(m, m->parked ? STEPPER_POWER_OFF : STEPPER_POWER_REDUCED);
+      break;
+
+    case STEPPER_POWER_REDUCED:
+      if (m->parked) EnterPower(m, STEPPER_POWER_OFF);
+      break;
+
+    case STEPPER_POWER_OFF:
+    default:
+      break;
+  }
+}
+
+void Stepper_SetParked(stepper_t *m, bool parked) { m->parked = parked; }
+
+stepper_power_t Stepper_GetPowerState(stepper_t *m) { return m->power; }
+
+void Stepper_GetPowerStats(stepper_t *m, stepper_power_stats_t *out)
+{
+  if (!out) return;
+  for (uint8_t i = 0; i < STEPPER_POWER_COUNT; i++)
+  {
+    out->ms[i] = m->pwrMs[i];
+    out->mj[i] = (uint32_t)(m->pwrUj[i] / 1000U);
+  }
 }
 
 
 /* ==============================
- *      동작 상태 확인
+ *  TIM4 CH2 비교 인터럽트 (ISR)
+ * ==============================
+ * REDUCED 상태인 모든 모터에 phase ON / 전체 OFF를 번갈아 출력
+ */
+static void OnChopTimer(void)
+{
+  s_chopOn = !s_chopOn;
+
+  for (uint8_t i = 0; i < STEPPER_TIM_CHANNELS; i++)
+  {
+    stepper_t *m = s_byCh[i];
+    if (!m || m->power != STEPPER_POWER_REDUCED || m->busy) continue;
+
+    if (s_chopOn) Stepper_WritePhase(m, m->stepIndex);
+    else          Stepper_WriteOff(m);
+  }
+
+  uint16_t ccr = (uint16_t)__HAL_TIM_GET_COMPARE(&htim4, TIM_CHANNEL_2);
+  __HAL_TIM_SET_COMPARE(&htim4, TIM_CHANNEL_2,
+                        (uint16_t)(ccr + (s_chopOn ? STEPPER_CHOP_ON_US
+                                                   : (STEPPER_CHOP_PERIOD_US - STEPPER_CHOP_ON_US))));
+}
+
+
+/* 현재 속도에 해당하는 테이블 인덱스(IntervalAt과 같은 규칙, 등속이면 rampLen) */
+static uint32_t RampIndexNow(const stepper_t *m)
+{
+	uint32_t i = m->stepsDone;
+	if (m->stepsTotal)
+	{
+		if (m->stepsDone >= m->stepsTotal) i = 0;          // 크립(START 속도) 중
+		else if (m->stepsTotal - m->stepsDone - 1 < i) i = m->stepsTotal - m->stepsDone - 1;
+	}
+	if (i > m->rampLen) i = m->rampLen;
+	return i;
+}
+
+
+/* ==============================
+ *        감속 정지
+ * ==============================
+ * 진행 중인 이동을 "현재 인덱스만큼 남은 프로파일 이동"으로 바꾼다.
+ * stepsTotal = stepsDone + i + 1 이면 IntervalAt이 ramp[i], ramp[i-1] ... ramp[0]을
+ * 차례로 읽으므로 평상시 감속과 같은 기울기로 START까지 내려온 뒤 스스로 정지한다.
+ * 이미 감속 구간이면 stepsTotal이 그대로라 아무 변화 없음.
+ */
+void Stepper_Decelerate(stepper_t *m)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!m->busy || m->emgActive)
+	{
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	uint32_t i = RampIndexNow(m);
+	m->stepsTotal = m->stepsDone + i + 1;
+	m->creepAfter = false;
+
+	/* DMA가 이미 계획해 둔 시각은 옛 stepsTotal 기준이므로 ISR 방식으로 전환 */
+	StopDma(m);
+
+	__set_PRIMASK(primask);
+}
+
+
+/* ==============================
+ *        비상 감속 정지
  * ============================== */
-bool Stepper_IsBusy(void) { return s_busy; }
+void Stepper_EmergencyStop(stepper_t *m, uint32_t max_steps)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!m->busy || m->emgActive)
+	{
+		if (!m->busy) m->emgSteps = 0;
+		__set_PRIMASK(primask);
+		return;
+	}
 
+	m->emgIdx = RampIndexNow(m);
+	m->emgLeft = max_steps / m->stride;
+	m->emgStartPos = m->position;
+
+	/* DMA 순서화 중이면 ISR 방식으로 전환 (CCR에 들어간 다음 시각은 그대로 사용) */
+	StopDma(m);
+
+	m->emgActive = true;
+	__set_PRIMASK(primask);
+}
+
+bool Stepper_IsEmergencyStopping(stepper_t *m) { return m->emgActive; }
+
+uint32_t Stepper_GetEmgStopSteps(stepper_t *m) { return m->emgSteps; }
 
 
 /* ==============================
- *     논블로킹 스텝 진행 Task
+ *      동작 상태 확인
  * ============================== */
-void Stepper_Task(void)
+bool Stepper_IsBusy(stepper_t *m) { return m->busy; }
+
+uint16_t Stepper_GetSpeed(stepper_t *m)
 {
-	/* 회전 시작 상태가 아니면 아무 것도 하지 않음 */
-	if (!s_busy) return;
+	if (!m->busy) return 0;
 
+	uint32_t idx = m->emgIdx;
+	uint16_t us = m->emgActive ? ((idx < m->rampLen) ? m->ramp[idx] : m->cruiseUs)
+	                           : IntervalAt(m, m->stepsDone);
+	return (uint16_t)(1000000UL / us);
+}
 
-	/* STEP_PERIOD_MS마다 1스텝 진행 */
-	uint32_t now = HAL_GetTick();
-	if (now - s_prevTick < STEP_PERIOD_MS) return;
-	s_prevTick = now;
+
+
+/* ==============================
+ *   스텝 비교 인터럽트 (ISR, 모터 1개)
+ * ============================== */
+static void OnStepTimer(stepper_t *m)
+{
+	/* Stop 직후 늦게 들어온 인터럽트는 무시 */
+	if (!m->busy) return;
 
 	/* 방향은 여기에서만 처리한다.
 	 * - 엘리베이터 로직에서 phase 순서를 뒤집거나 인덱스를 조작하지 말 것
 	 */
-	if (s_dir == DIR_UP)
-		s_stepIndex = (s_stepIndex + 1) & 0x07;
+	if (m->dir == DIR_UP)
+	{
+		m->stepIndex = (m->stepIndex + m->stride) & 0x07;
+		m->position += m->stride;
+	}
 	else
-		s_stepIndex = (s_stepIndex + 7) & 0x07;   // -1 mod 8
+	{
+		m->stepIndex = (m->stepIndex - m->stride) & 0x07;   // -stride mod 8
+		m->position -= m->stride;
+	}
+
+	Stepper_WritePhase(m, m->stepIndex);
+	m->stepsDone++;
+
+	/* 프로파일 이동 완료: 마지막 phase를 유지한 채 정지 (크립이면 계속 회전) */
+	if (m->stepsTotal && m->stepsDone >= m->stepsTotal && !m->creepAfter)
+	{
+		StopTimer(m);
+		m->busy = false;
+		EndEmg(m);
+		return;
+	}
+
+	/* 비상 감속: START 속도까지 내려왔거나 허용 거리를 다 쓰면 정지(홀드) */
+	if (m->emgActive)
+	{
+		if (m->emgIdx == 0 || m->emgLeft == 0)
+		{
+			StopTimer(m);
+			m->busy = false;
+			EndEmg(m);
+			return;
+		}
+		m->emgLeft--;
+		m->emgIdx = (m->emgIdx > STEPPER_EMG_DECEL_MULT) ? (m->emgIdx - STEPPER_EMG_DECEL_MULT) : 0;
+
+		uint16_t interval = (m->emgIdx < m->rampLen) ? m->ramp[m->emgIdx] : m->cruiseUs;
+		*Ccr(m) = (uint16_t)(*Ccr(m) + interval);
+		return;
+	}
+
+	/* DMA 모드: 다음 비교값은 이미 DMA가 CCR에 써 넣었음 */
+	if (m->dmaActive) return;
 
-	Stepper_WritePhase(s_stepIndex);
+	/* 다음 스텝 시각 예약: 16bit 카운터 랩어라운드는 덧셈 오버플로로 자연 처리 */
+	*Ccr(m) = (uint16_t)(*Ccr(m) + IntervalAt(m, m->stepsDone));
 }
 
 
+/* ==============================
+ *   TIM4 비교 인터럽트 분배 (ISR)
+ * ==============================
+ * HAL_TIM_ACTIVE_CHANNEL_1/2/3/4 = 0x01/0x02/0x04/0x08
+ * 여러 채널이 한 번에 일치하면 HAL이 채널마다 콜백을 따로 부른다.
+ */
+void Stepper_OnTimerIrq(uint32_t active_channel)
+{
+	for (uint8_t i = 0; i < STEPPER_TIM_CHANNELS; i++)
+	{
+		if (!(active_channel & (1U << i))) continue;
+
+		if (i == CHOP_CH_IDX)  OnChopTimer();
+		else if (s_byCh[i])    OnStepTimer(s_byCh[i]);
+	}
+}
+
+
+
+/* ==============================
+ *   phase 출력 사이클 벤치마크
+ * ==============================
+ * DWT 사이클 카운터로 기존(HAL x4) / BSRR 방식을 각각 n회 측정.
+ * 현재 phase를 다시 쓰기만 하므로 모터는 움직이지 않는다.
+ * 측정 동안 인터럽트를 막으므로(n=1000에서 약 1ms) UART ISR이 아니라 main 루프에서 호출.
+ * 끝나면 전원 상태의 출력을 되돌린다(OFF: 전부 끔, REDUCED: 현재 초핑 위상).
+ */
+bool Stepper_BenchPhaseOutput(stepper_t *m, uint32_t n, uint32_t *halCycles, uint32_t *bsrrCycles)
+{
+  if (m->busy || n == 0) return false;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  uint8_t ph = m->stepIndex;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+
+  uint32_t t0 = DWT->CYCCNT;
+  for (uint32_t i = 0; i < n; i++) Stepper_WritePhaseHal(m, ph);
+  uint32_t t1 = DWT->CYCCNT;
+  for (uint32_t i = 0; i < n; i++) Stepper_WritePhase(m, ph);
+  uint32_t t2 = DWT->CYCCNT;
+
+  /* 측정 중에는 코일을 계속 켰으므로 전원 상태의 출력으로 복원 (EnterPower와 같은 규칙) */
+  if (m->power == STEPPER_POWER_OFF ||
+      (m->power == STEPPER_POWER_REDUCED && !s_chopOn)) Stepper_WriteOff(m);
+
+  __set_PRIMASK(primask);
+
+  if (halCycles)  *halCycles  = t1 - t0;
+  if (bsrrCycles) *bsrrCycles = t2 - t1;
+  return true;
+}
@@ -0,0 +1,131 @@
+/*
+ * fake_car.c
+ *
+ *  elevator.c가 부르는 주변 모듈(button/servo/led/photo/shaft/beam/param/logger)의 가짜 구현.
+ *  스텝모터(stepper.c)와 문 대기(dwell.c), 포토 디코더(floor_fsm.c)는 실제 코드를 쓴다.
+ */
+
+#include "fake_car.h"
+#include "host_hal.h"
+#include "elevator.h"
+#include "button.h"
+#include "servo.h"
+#include "led.h"
+#include "photo.h"
+#include "shaft.h"
+#include "beam.h"
+#include "param.h"
+#include "logger.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+fake_car_t fake_car;
+
+static uint32_t    s_pressed;
+static uint32_t    s_idleMs;     // 모터가 멈춰 있던 동안 흘린 시간(TIM4 시계는 스텝으로만 진행)
+static shaft_map_t s_map;        // valid = 0
+static param_t     s_param;
+
+static const stepper_hw_t s_hw =
+{
+  .port    = { GPIOA, GPIOB, GPIOC, GPIOC },
+  .pin     = { GPIO_PIN_4, GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_0 },
+  .channel = TIM_CHANNEL_1,
+};
+
+
+/* ==============================
+ *        시뮬레이션 제어
+ * ============================== */
+void FakeCar_Init(void)
+{
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  memset(&fake_car, 0, sizeof(fake_car));
+  s_pressed = 0;
+  s_idleMs = 0;
+  host_tick = 0;
+
+  Stepper_Init(&hstepper1, &s_hw);
+  FloorFSM_Init();
+  Dwell_Init();
+  Elevator_Init();
+}
+
+void FakeCar_Press(uint8_t btn) { s_pressed |= 1UL << btn; }
+
+uint32_t FakeCar_Ms(void) { return host_tick; }
+
+void FakeCar_Loop(void)
+{
+  Elevator_InputTask();
+  Elevator_Task();
+  Stepper_Task(&hstepper1);
+
+  if (!HostTim4_Run(NULL)) s_idleMs++;
+  host_tick = s_idleMs + (uint32_t)(HostTim4_Now() / 1000U);
+}
+
+bool FakeCar_InWindow(uint8_t f)
+{
+  int32_t d = Stepper_GetPosition(&hstepper1) - FAKE_FLOOR_POS(f);
+  return d > -FAKE_WINDOW / 2 && d < FAKE_WINDOW / 2;
+}
+
+
+/* ==============================
+ *        가짜 주변 모듈
+ * ============================== */
+bool Button_GetPressed(uint8_t num)
+{
+  bool p = (s_pressed >> num) & 1U;
+  s_pressed &= ~(1UL << num);
+  return p;
+}
+
+void Servo_Open(void)
+{
+  fake_car.opens++;
+  if (Stepper_IsBusy(&hstepper1) && Stepper_GetSpeed(&hstepper1) > FAKE_OPEN_SPS_MAX) fake_car.opensFast++;
+  fake_car.doorOpen = true;
+}
+void Servo_Close(void) { fake_car.doorOpen = false; }
+bool Servo_IsOpened(void) { return fake_car.doorOpen; }
+bool Servo_IsClosed(void) { return !fake_car.doorOpen; }
+
+void ledUp(void) { }
+void ledDown(void) { }
+void ledOff(void) { }
+
+photo_fsm_t Photo_GetFSM(void)
+{
+  for (uint8_t f = 1; f <= SHAFT_FLOORS; f++)
+    if (FakeCar_InWindow(f)) return (photo_fsm_t)(PF_F1 + f - 1);
+  return PF_UNKNOWN;
+}
+
+void Shaft_OnMoveStart(uint8_t dir) { }
+shaft_fault_t Shaft_GetFault(void) { return SHAFT_FAULT_NONE; }
+void Shaft_ClearFault(void) { }
+void Shaft_CalBegin(void) { }
+bool Shaft_CalEnd(bool ok) { return false; }
+const shaft_map_t* Shaft_GetMap(void) { return &s_map; }
+bool Shaft_IsReferenced(void) { return false; }
+bool Shaft_GetFloorCenter(uint8_t floor, int32_t *center) { return false; }
+
+bool Beam_IsBlocked(void) { return false; }
+bool Beam_IsEnabled(void) { return false; }
+
+bool Param_IsValid(void) { return false; }
+param_t* Param_Get(void) { return &s_param; }
+bool Param_Save(void) { return true; }
+
+void Log_Printf(const char *fmt, ...)
+{
+  va_list ap;
+  printf("  [%6u ms] ", host_tick);
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+}
@@ -0,0 +1,47 @@
+/*
+ * fake_car.h
+ *
+ *  elevator.c 호스트 테스트용 가짜 주변 장치 (fake_car.c)
+ *  - 승강로: 스텝모터 위치(half-step)로 층 센서를 흉내 낸다
+ *    층 f의 창 = FAKE_FLOOR_POS(f) +- FAKE_WINDOW/2, 창 밖은 PF_UNKNOWN
+ *  - shaft map 없음(PlanArrival 미사용, 레벨링은 진입점 기준), 샤프트 이상 없음
+ *  - 문: Servo_Open/Close 즉시 끝 위치, 빔 센서 꺼짐, FLASH 저장 없음
+ *  - 버튼: FakeCar_Press()로 누르면 다음 Button_GetPressed()에서 한 번 참
+ */
+
+#ifndef FAKE_CAR_H_
+#define FAKE_CAR_H_
+
+#include "stepper.h"
+#include <stdbool.h>
+
+#define FAKE_FLOOR_POS(f)  ((int32_t)((f) - 1) * 2000)
+#define FAKE_WINDOW        600
+
+typedef struct
+{
+  uint32_t opens;          // Servo_Open 호출 수
+  uint32_t opensFast;      // 모터가 FAKE_OPEN_SPS_MAX 넘게 돌고 있을 때 Servo_Open 호출 수
+  bool     doorOpen;
+} fake_car_t;
+
+#define FAKE_OPEN_SPS_MAX  600
+
+extern fake_car_t fake_car;
+
+/* HAL/타이머/엘리베이터 초기화 (1층 중앙, 문 닫힘) */
+void FakeCar_Init(void);
+
+/* 버튼 한 번 누름 (BUTTON_table 값) */
+void FakeCar_Press(uint8_t btn);
+
+/* main 루프 한 바퀴(Elevator_InputTask/Task, Stepper_Task) + 스텝 1개 또는 1ms 진행 */
+void FakeCar_Loop(void);
+
+/* 시뮬레이션 시각(ms) */
+uint32_t FakeCar_Ms(void);
+
+/* 현재 위치가 층 f의 창 안인지 */
+bool FakeCar_InWindow(uint8_t f);
+
+#endif /* FAKE_CAR_H_ */
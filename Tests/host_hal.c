@@ -0,0 +1,162 @@
+/*
+ * host_hal.c
+ *
+ *  호스트 테스트용 HAL 대체 구현 (GPIO/TIM/DMA/틱)
+ *  실제 주변장치 동작 중 테스트 대상 모듈이 기대하는 부분만 흉내 낸다.
+ */
+
+#include "host_hal.h"
+#include "tim.h"
+#include <string.h>
+
+
+uint32_t host_primask;
+uint32_t host_tick;
+uint32_t host_gpio_writes;
+void   (*host_tim4_irq)(uint32_t active_channel);
+
+GPIO_TypeDef   host_gpio[HOST_GPIO_PORTS];
+CoreDebug_Type host_coredebug;
+DWT_Type       host_dwt;
+
+static TIM_TypeDef s_tim[5];
+TIM_HandleTypeDef htim1  = { .Instance = &s_tim[0] };
+TIM_HandleTypeDef htim3  = { .Instance = &s_tim[1] };
+TIM_HandleTypeDef htim4  = { .Instance = &s_tim[2] };
+TIM_HandleTypeDef htim5  = { .Instance = &s_tim[3] };
+TIM_HandleTypeDef htim11 = { .Instance = &s_tim[4] };
+
+/* TIM4 CH1 DMA (펌웨어의 hdma_tim4_ch1과 같은 연결) */
+static DMA_HandleTypeDef s_dmaTim4Ch1;
+
+static uint8_t  s_tim4On;          // 비교 인터럽트가 켜진 채널 비트(0~3)
+static uint8_t  s_tim4Wrap;        // CCR == CNT로 남은 채널: 다음 일치는 한 바퀴 뒤
+static uint64_t s_tim4Us;
+
+
+uint32_t HAL_GetTick(void) { return host_tick; }
+
+
+void HostHal_Reset(void)
+{
+  memset(host_gpio, 0, sizeof(host_gpio));
+  memset(s_tim, 0, sizeof(s_tim));
+  memset(&s_dmaTim4Ch1, 0, sizeof(s_dmaTim4Ch1));
+  htim4.hdma[TIM_DMA_ID_CC1] = &s_dmaTim4Ch1;
+  s_tim4On = 0;
+  s_tim4Wrap = 0;
+  s_tim4Us = 0;
+  host_primask = 0;
+  host_gpio_writes = 0;
+}
+
+
+/* ==============================
+ *        GPIO
+ * ============================== */
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  host_gpio_writes++;
+  if (PinState == GPIO_PIN_SET) GPIOx->ODR |= GPIO_Pin;
+  else                          GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+
+/* ==============================
+ *        DMA (circular, halfword, mem -> periph)
+ * ============================== */
+/* 주소 인자가 32bit라 64bit 호스트에서는 상위 32bit가 잘린다.
+ * 버퍼(stepper_t)와 CCR(s_tim)은 모두 정적 데이터 영역에 있으므로 s_tim 주소의 상위 비트로 복원.
+ * (스택에 잡은 stepper_t로는 DMA 모드를 쓸 수 없음) */
+static void *HostAddr(uint32_t addr)
+{
+  return (void *)(((uintptr_t)&s_tim[0] & ~(uintptr_t)0xFFFFFFFFu) | addr);
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength)
+{
+  if (hdma->running || DataLength == 0) return HAL_BUSY;
+  hdma->src = (const uint16_t *)HostAddr(SrcAddress);
+  hdma->dst = (volatile uint32_t *)HostAddr(DstAddress);
+  hdma->len = DataLength;
+  hdma->idx = 0;
+  hdma->running = 1;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort_IT(DMA_HandleTypeDef *hdma)
+{
+  hdma->running = 0;
+  return HAL_OK;
+}
+
+
+/* ==============================
+ *        TIM4 (1us free-running)
+ * ============================== */
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+  if (htim == &htim4)
+  {
+    s_tim4On |= (uint8_t)(1U << (Channel >> 2));
+    s_tim4Wrap &= (uint8_t)~(1U << (Channel >> 2));
+  }
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+  if (htim == &htim4) s_tim4On &= (uint8_t)~(1U << (Channel >> 2));
+  return HAL_OK;
+}
+
+bool HostTim4_ChannelOn(uint8_t ch) { return (s_tim4On >> ch) & 1U; }
+
+uint64_t HostTim4_Now(void) { return s_tim4Us; }
+
+bool HostTim4_Run(uint8_t *ch)
+{
+  TIM_TypeDef *t = htim4.Instance;
+  volatile uint32_t *ccr = &t->CCR1;
+  uint32_t best = 0x20000;
+  uint8_t  hit = 0;
+
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    if (!HostTim4_ChannelOn(i)) continue;
+    uint32_t d = (uint16_t)(ccr[i] - t->CNT);
+    if (d == 0 && ((s_tim4Wrap >> i) & 1U)) d = 0x10000;
+    if (d < best) { best = d; hit = i; }
+  }
+  if (best == 0x20000) return false;
+
+  s_tim4Us += best;
+  t->CNT = (uint16_t)(t->CNT + best);
+  s_tim4Wrap &= (uint8_t)~(1U << hit);
+
+  /* 비교 일치 DMA 요청: 인터럽트보다 먼저 다음 비교값이 들어감 */
+  DMA_HandleTypeDef *hdma = htim4.hdma[TIM_DMA_ID_CC1 + hit];
+  if ((t->DIER & (TIM_DMA_CC1 << hit)) && hdma && hdma->running)
+  {
+    *hdma->dst = hdma->src[hdma->idx++];
+    if (hdma->idx == hdma->len / 2 && hdma->XferHalfCpltCallback) hdma->XferHalfCpltCallback(hdma);
+    if (hdma->idx == hdma->len)
+    {
+      hdma->idx = 0;
+      if (hdma->XferCpltCallback) hdma->XferCpltCallback(hdma);
+    }
+  }
+
+  if (host_tim4_irq) host_tim4_irq(1U << hit);
+
+  /* ISR이 비교값을 옮기지 않았으면 다음 일치는 16bit 한 바퀴 뒤 */
+  if (HostTim4_ChannelOn(hit) && (uint16_t)ccr[hit] == (uint16_t)t->CNT) s_tim4Wrap |= (uint8_t)(1U << hit);
+
+  if (ch) *ch = hit;
+  return true;
+}
@@ -0,0 +1,36 @@
+/*
+ * host_hal.h
+ *
+ *  호스트 테스트용 HAL 대체 구현(host_hal.c)의 시뮬레이션 제어 API
+ *  - HAL_GetTick()은 host_tick을 그대로 돌려준다 (테스트가 직접 진행)
+ *  - TIM4는 1us free-running 16bit 카운터로 흉내 내고, 비교 일치마다
+ *    host_tim4_irq(HAL_TIM_ACTIVE_CHANNEL_x)를 부른다 (보통 Stepper_OnTimerIrq)
+ *  - CCx DMA 요청이 켜진 채널은 일치 시 DMA 버퍼 다음 값을 CCR에 먼저 써 넣는다
+ */
+
+#ifndef HOST_HAL_H_
+#define HOST_HAL_H_
+
+#include "stm32f4xx_hal.h"
+#include <stdbool.h>
+
+extern uint32_t host_tick;                       // HAL_GetTick() 값(ms)
+extern uint32_t host_gpio_writes;                // HAL_GPIO_WritePin 호출 수
+extern void   (*host_tim4_irq)(uint32_t active_channel);
+
+/* TIM4/DMA/GPIO 상태 초기화 (카운터 0, 모든 채널 정지) */
+void HostHal_Reset(void);
+
+/* TIM4 시작 후 경과 시간(us, 랩어라운드 없음) */
+uint64_t HostTim4_Now(void);
+
+/* 켜진 비교 채널 중 가장 먼저 일치하는 곳까지 카운터를 진행하고 인터럽트 처리
+ * @param ch : 일치한 채널 인덱스(0~3), NULL 가능
+ * @retval false : 켜진 채널이 없음 (모든 모터 정지)
+ */
+bool HostTim4_Run(uint8_t *ch);
+
+/* TIM4 비교 채널 인터럽트가 켜져 있는지 (인덱스 0~3) */
+bool HostTim4_ChannelOn(uint8_t ch);
+
+#endif /* HOST_HAL_H_ */
@@ -0,0 +1,29 @@
+/*
+ * host_test.h
+ *
+ *  호스트 테스트 공통: 실패 카운트 + CHECK 매크로
+ *  main()은 마지막에 HOST_TEST_RESULT()를 돌려준다 (실패가 있으면 1 -> ctest 실패)
+ */
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdio.h>
+
+static int host_fails;
+
+#define CHECK(cond, ...)                                              \
+  do {                                                                \
+    if (!(cond))                                                      \
+    {                                                                 \
+      host_fails++;                                                   \
+      printf("FAIL %s:%d: (%s) ", __FILE__, __LINE__, #cond);         \
+      printf(__VA_ARGS__);                                            \
+      printf("\n");                                                   \
+    }                                                                 \
+  } while (0)
+
+#define HOST_TEST_RESULT()                                            \
+  (printf("%s: %s\n", __FILE__, host_fails ? "FAILED" : "OK"), host_fails ? 1 : 0)
+
+#endif /* HOST_TEST_H_ */
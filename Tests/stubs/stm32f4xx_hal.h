@@ -0,0 +1,180 @@
+/*
+ * stm32f4xx_hal.h (호스트 테스트용 대체 헤더)
+ *
+ *  HAL 없이 PC에서 순수 로직 모듈(stepper, floor_fsm, dwell 등)을 빌드하기 위한 최소 정의.
+ *  레지스터는 평범한 구조체 변수이고, TIM4/DMA 동작은 host_hal.c가 흉내 낸다.
+ *  펌웨어 빌드에는 쓰이지 않는다 (Tests/ 는 CubeIDE 소스 경로 밖).
+ */
+
+#ifndef HOST_STM32F4XX_HAL_H_
+#define HOST_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/* ==============================
+ *        HAL 공통
+ * ============================== */
+typedef enum
+{
+  HAL_OK = 0,
+  HAL_ERROR,
+  HAL_BUSY,
+  HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+uint32_t HAL_GetTick(void);
+
+
+/* ==============================
+ *        코어(인터럽트 마스크)
+ * ==============================
+ * 호스트에는 인터럽트가 없으므로 PRIMASK만 흉내 낸다.
+ */
+extern uint32_t host_primask;
+
+static inline uint32_t __get_PRIMASK(void) { return host_primask; }
+static inline void __set_PRIMASK(uint32_t v) { host_primask = v; }
+static inline void __disable_irq(void) { host_primask = 1; }
+static inline void __enable_irq(void) { host_primask = 0; }
+static inline void __DMB(void) { }
+
+
+/* ==============================
+ *        GPIO
+ * ============================== */
+typedef enum
+{
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct
+{
+  volatile uint32_t IDR;
+  volatile uint32_t ODR;
+  volatile uint32_t BSRR;     // 마지막으로 쓴 값이 그대로 남음(테스트에서 판독)
+} GPIO_TypeDef;
+
+#define HOST_GPIO_PORTS  8
+extern GPIO_TypeDef host_gpio[HOST_GPIO_PORTS];
+
+#define GPIOA  (&host_gpio[0])
+#define GPIOB  (&host_gpio[1])
+#define GPIOC  (&host_gpio[2])
+#define GPIOD  (&host_gpio[3])
+#define GPIOE  (&host_gpio[4])
+#define GPIOH  (&host_gpio[7])
+
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+
+/* ==============================
+ *        DMA
+ * ============================== */
+typedef struct __DMA_HandleTypeDef
+{
+  void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+  void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+  void (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+
+  /* 호스트 시뮬레이션 상태 (circular, halfword) */
+  const uint16_t    *src;
+  volatile uint32_t *dst;
+  uint32_t           len;
+  uint32_t           idx;
+  uint8_t            running;
+} DMA_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort_IT(DMA_HandleTypeDef *hdma);
+
+
+/* ==============================
+ *        TIM
+ * ==============================
+ * CCR1~CCR4는 실제 레지스터처럼 연속 배치 (stepper.c가 CCR1 + 채널 인덱스로 접근)
+ */
+typedef struct
+{
+  volatile uint32_t CNT;
+  volatile uint32_t CCR1;
+  volatile uint32_t CCR2;
+  volatile uint32_t CCR3;
+  volatile uint32_t CCR4;
+  volatile uint32_t DIER;
+} TIM_TypeDef;
+
+typedef struct
+{
+  TIM_TypeDef       *Instance;
+  uint32_t           Channel;
+  DMA_HandleTypeDef *hdma[7];
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1   0x00000000U
+#define TIM_CHANNEL_2   0x00000004U
+#define TIM_CHANNEL_3   0x00000008U
+#define TIM_CHANNEL_4   0x0000000CU
+
+#define HAL_TIM_ACTIVE_CHANNEL_1  0x01U
+#define HAL_TIM_ACTIVE_CHANNEL_2  0x02U
+#define HAL_TIM_ACTIVE_CHANNEL_3  0x04U
+#define HAL_TIM_ACTIVE_CHANNEL_4  0x08U
+
+#define TIM_DMA_ID_CC1  0x0001U
+#define TIM_DMA_CC1     0x00000200U
+
+#define __HAL_TIM_GET_COUNTER(h)           ((h)->Instance->CNT)
+#define __HAL_TIM_SET_COMPARE(h, ch, v)    (*(&(h)->Instance->CCR1 + ((ch) >> 2)) = (v))
+#define __HAL_TIM_GET_COMPARE(h, ch)       (*(&(h)->Instance->CCR1 + ((ch) >> 2)))
+#define __HAL_TIM_ENABLE_DMA(h, d)         ((h)->Instance->DIER |= (d))
+#define __HAL_TIM_DISABLE_DMA(h, d)        ((h)->Instance->DIER &= ~(uint32_t)(d))
+
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef *htim, uint32_t Channel);
+
+
+/* ==============================
+ *        UART (logger.h 선언용, 호스트에서는 쓰지 않음)
+ * ============================== */
+typedef struct { void *Instance; } UART_HandleTypeDef;
+
+
+/* ==============================
+ *        DWT (사이클 카운터)
+ * ==============================
+ * 호스트에서는 세지 않는다(항상 0). 사이클 비교는 test_phase_cost.c의 비용 모델 참고.
+ */
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+typedef struct { volatile uint32_t CTRL; volatile uint32_t CYCCNT; } DWT_Type;
+
+extern CoreDebug_Type host_coredebug;
+extern DWT_Type       host_dwt;
+
+#define CoreDebug                    (&host_coredebug)
+#define DWT                          (&host_dwt)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+
+
+#endif /* HOST_STM32F4XX_HAL_H_ */
@@ -0,0 +1,18 @@
+/*
+ * tim.h (호스트 테스트용 대체 헤더)
+ *
+ *  타이머 핸들은 host_hal.c에 정의. TIM4는 host_hal.c가 1us free-running으로 흉내 낸다.
+ */
+
+#ifndef HOST_TIM_H_
+#define HOST_TIM_H_
+
+#include "stm32f4xx_hal.h"
+
+extern TIM_HandleTypeDef htim1;
+extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
+extern TIM_HandleTypeDef htim5;
+extern TIM_HandleTypeDef htim11;
+
+#endif /* HOST_TIM_H_ */
@@ -0,0 +1,119 @@
+/*
+ * test_arrival_plan.c
+ *
+ *  도착 방식별 한 층 이동 시간 시뮬레이션 (elevator.c PlanArrival vs 센서 정지)
+ *
+ *  카는 위치 0(출발층 중앙)에서 위로 간다. 목표층 센서 창은 [edge, edge + WINDOW),
+ *  중앙은 floor spacing 위치. 센서는 매 스텝 직후 위치로 판정한다(포토 디바운스 지연 제외).
+ *  세 방식 모두 센서를 보면 감속 정지 후 창 중앙까지 이동(레벨링)해서 끝난다.
+ *   - sensor  : 연속 회전, 센서에서 감속 정지 (map 없을 때의 기존 방식)
+ *   - planned : MoveToCreep(edge - ARRIVE_CREEP_STEPS), 센서까지 START 속도 크립
+ *   - crawl   : 처음부터 START 속도 등속(안전하지만 느린 기준)
+ *  이동 시간, 센서 진입 속도, 센서 후 오버런을 비교한다.
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "stepper.h"
+
+#define ARRIVE_CREEP_STEPS  64     // elevator.c와 같은 값
+#define WINDOW              200    // 센서 창 폭(half-step)
+
+typedef enum { ARR_SENSOR, ARR_PLANNED, ARR_CRAWL } arrival_t;
+
+typedef struct
+{
+  double   timeS;       // 출발 ~ 창 중앙 정지
+  double   edgeSps;     // 센서 진입 시 속도
+  int32_t  overrun;     // 센서 경계를 지나 감속 정지까지 간 거리
+  int32_t  finalPos;
+} trip_t;
+
+static stepper_t s_m;
+
+static const stepper_hw_t s_hw =
+{
+  .port    = { GPIOA, GPIOB, GPIOC, GPIOC },
+  .pin     = { GPIO_PIN_4, GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_0 },
+  .channel = TIM_CHANNEL_1,
+};
+
+static void RunAll(void)
+{
+  while (HostTim4_Run(NULL)) { }
+}
+
+static trip_t Trip(arrival_t how, int32_t spacing)
+{
+  trip_t  t = { 0 };
+  int32_t edge = spacing - WINDOW / 2;
+  uint64_t prev = 0, now = 0;
+
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  Stepper_Init(&s_m, &s_hw);
+
+  if (how == ARR_CRAWL)
+    Stepper_SetProfile(&s_m, STEPPER_START_SPS_DEFAULT, STEPPER_START_SPS_DEFAULT, STEPPER_ACCEL_DEFAULT);
+
+  if (how == ARR_PLANNED) Stepper_MoveToCreep(&s_m, edge - ARRIVE_CREEP_STEPS, DIR_UP);
+  else                    Stepper_StartContinuous(&s_m, DIR_UP);
+
+  /* 센서까지 */
+  while (Stepper_GetPosition(&s_m) < edge && HostTim4_Run(NULL))
+  {
+    prev = now;
+    now  = HostTim4_Now();
+  }
+  t.edgeSps = (now > prev) ? 1e6 / (double)(now - prev) : 0;
+
+  /* 센서 감지: 감속 정지 -> 창 중앙까지 (elevator.c BrakeThenLevel/LevelToCenter) */
+  Stepper_Decelerate(&s_m);
+  RunAll();
+  t.overrun = Stepper_GetPosition(&s_m) - edge;
+
+  Stepper_MoveTo(&s_m, spacing);
+  RunAll();
+
+  t.timeS    = HostTim4_Now() / 1e6;
+  t.finalPos = Stepper_GetPosition(&s_m);
+  return t;
+}
+
+
+int main(void)
+{
+  static const int32_t spacing[] = { 1000, 2000 };
+  static const char *const names[] = { "sensor", "planned", "crawl" };
+
+  printf("profile %u/%u sps, %u sps/s, window %u hs, creep %u hs\n\n",
+         STEPPER_START_SPS_DEFAULT, STEPPER_CRUISE_SPS_DEFAULT, STEPPER_ACCEL_DEFAULT,
+         WINDOW, ARRIVE_CREEP_STEPS);
+  printf("spacing  arrival   time(s)  edge sps  overrun(hs)\n");
+
+  for (size_t k = 0; k < sizeof(spacing) / sizeof(spacing[0]); k++)
+  {
+    trip_t r[3];
+
+    for (int how = ARR_SENSOR; how <= ARR_CRAWL; how++)
+    {
+      r[how] = Trip((arrival_t)how, spacing[k]);
+      printf("%7d  %-8s  %7.3f  %8.0f  %11d\n", spacing[k], names[how],
+             r[how].timeS, r[how].edgeSps, r[how].overrun);
+      CHECK(r[how].finalPos == spacing[k], "%s %d: stopped at %d", names[how], spacing[k], r[how].finalPos);
+    }
+
+    /* 계획 도착은 START 속도로 센서에 들어가고, 오버런이 창 안에 머문다 */
+    CHECK(r[ARR_PLANNED].edgeSps <= STEPPER_START_SPS_DEFAULT + 1,
+          "planned %d: edge speed %.0f sps", spacing[k], r[ARR_PLANNED].edgeSps);
+    CHECK(r[ARR_PLANNED].overrun < r[ARR_SENSOR].overrun,
+          "planned %d: overrun %d >= sensor %d", spacing[k], r[ARR_PLANNED].overrun, r[ARR_SENSOR].overrun);
+    /* 시간: 센서 정지는 등속 속도로 창을 지나쳐 되돌아와야 하므로 계획 도착이 가장 빠르다 */
+    CHECK(r[ARR_PLANNED].timeS <= r[ARR_SENSOR].timeS,
+          "planned %d: %.3f s slower than sensor %.3f s", spacing[k], r[ARR_PLANNED].timeS, r[ARR_SENSOR].timeS);
+    CHECK(r[ARR_PLANNED].timeS < r[ARR_CRAWL].timeS,
+          "planned %d: %.3f s not faster than crawl %.3f s", spacing[k], r[ARR_PLANNED].timeS, r[ARR_CRAWL].timeS);
+  }
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+/*
+ * test_dwell.c
+ *
+ *  문 열림 대기(dwell.c) 결정 로직을 가짜 시계(ms)와 가짜 빔 센서로 검사
+ *  - 기본 대기 / 카 호출 없을 때 단축 / 카 호출·같은 층 호출로 연장(최대 DWELL_MAX_MS)
+ *  - 빔이 끊겨 있는 동안 닫지 않음, 풀리면 DWELL_BEAM_CLEAR_MS 뒤 닫기
+ *  - 닫히는 중 빔 끊김 -> 되열기, 빔이 끊겨 있으면 CLOSE 버튼 무시
+ *  - 통계 누적
+ */
+
+#include "host_test.h"
+#include "dwell.h"
+
+/* 가짜 센서: [blockFrom, blockTo) 동안 빔 끊김 */
+static uint32_t s_blockFrom, s_blockTo;
+/* 가짜 카 호출: callAt[] 시각마다 순번 +1 */
+static uint32_t s_callAt[6];
+static uint8_t  s_nCalls;
+static uint8_t  s_seq;
+
+static void Fake(uint32_t blockFrom, uint32_t blockTo)
+{
+  s_blockFrom = blockFrom;
+  s_blockTo = blockTo;
+  s_nCalls = 0;
+}
+
+/* t0에 대기 시작, 1ms씩 진행해 닫기 시각 반환 (t0 기준) */
+static uint32_t RunDwell(bool hall, bool beamEnabled)
+{
+  const uint32_t t0 = 100000;   // 0이 아닌 시각에서 시작(상대 시간 계산 확인)
+
+  Dwell_Begin(t0, hall, beamEnabled, s_seq);
+  for (uint32_t t = 0; t <= 2 * DWELL_MAX_MS; t++)
+  {
+    for (uint8_t i = 0; i < s_nCalls; i++)
+      if (s_callAt[i] == t) s_seq++;
+
+    bool blocked = beamEnabled && t >= s_blockFrom && t < s_blockTo;
+    if (Dwell_Task(t0 + t, blocked, s_seq))
+    {
+      Dwell_End(t0 + t, false);
+      return t;
+    }
+  }
+  return UINT32_MAX;
+}
+
+static void Expect(const char *name, uint32_t got, uint32_t want)
+{
+  printf("%-34s close @%5u ms (expect %5u)\n", name, got, want);
+  CHECK(got == want, "%s: closed at %u, expected %u", name, got, want);
+}
+
+
+int main(void)
+{
+  dwell_stats_t st;
+
+  Dwell_Init();
+
+  /* 1) 빔 센서 없음: 카 호출이 없으면 DWELL_WINDOW_MS에서 *_IDLE_MS로 단축 */
+  Fake(0, 0);
+  Expect("car stop, nobody boards", RunDwell(false, false), DWELL_CAR_IDLE_MS);
+  Expect("hall stop, nobody boards", RunDwell(true, false), DWELL_HALL_IDLE_MS);
+  CHECK(Dwell_IsHall(), "hall flag not latched by Dwell_Begin");
+
+  /* 2) 창 안의 카 호출: 그 시점 + DWELL_EXTEND_MS, 단축 없음 */
+  Fake(0, 0);
+  s_callAt[0] = 1200; s_nCalls = 1;
+  Expect("car call at 1200 ms", RunDwell(false, false), 1200 + DWELL_EXTEND_MS);
+  CHECK(Dwell_GetCalls() == 1, "calls %u", Dwell_GetCalls());
+
+  /* 창이 지난 뒤 카 호출(이미 단축된 뒤에도 연장) */
+  Fake(0, 0);
+  s_callAt[0] = 1800; s_nCalls = 1;
+  Expect("car call at 1800 ms (after window)", RunDwell(false, false), 1800 + DWELL_EXTEND_MS);
+
+  /* 순번 8bit 랩어라운드에도 호출 수를 센다
+   * (500 + DWELL_EXTEND_MS가 기본 대기보다 짧으면 연장 없이 기본 대기, 단축도 없음) */
+  Fake(0, 0);
+  s_seq = 254;
+  s_callAt[0] = 500; s_callAt[1] = 500; s_callAt[2] = 500; s_nCalls = 3;
+  Expect("3 calls across seq wrap", RunDwell(false, false), DWELL_CAR_MS);
+  CHECK(Dwell_GetCalls() == 3, "calls across wrap %u", Dwell_GetCalls());
+
+  /* 3) 연장 상한: 계속 호출이 와도 DWELL_MAX_MS */
+  Fake(0, 0);
+  s_callAt[0] = 1200; s_callAt[1] = 4000; s_callAt[2] = 6900;
+  s_callAt[3] = 9800; s_callAt[4] = 12700; s_nCalls = 5;
+  Expect("calls until 12700 ms (cap)", RunDwell(false, false), DWELL_MAX_MS);
+
+  /* Dwell_Extend(같은 층 호출/OPEN 버튼)도 같은 규칙 */
+  Dwell_Begin(0, false, false, s_seq);
+  Dwell_Extend(1300);
+  CHECK(!Dwell_Task(1300 + DWELL_EXTEND_MS - 1, false, s_seq), "extend: closed early");
+  CHECK(Dwell_Task(1300 + DWELL_EXTEND_MS, false, s_seq), "extend: not closed on time");
+  Dwell_End(1300 + DWELL_EXTEND_MS, false);
+
+  /* 4) 빔 센서 사용: 짧은 기본 대기, 끊겨 있는 동안은 닫지 않음 */
+  Fake(0, 0);
+  Expect("beam on, car stop, nobody", RunDwell(false, true), DWELL_BEAM_CAR_MS);
+  Expect("beam on, hall stop, nobody", RunDwell(true, true), DWELL_BEAM_HALL_MS);
+
+  /* 끊김이 단축 판정 창(DWELL_WINDOW_MS)을 넘겨도 풀린 뒤 타이머가 유지되어야 한다 */
+  Fake(500, 5000);
+  Expect("beam blocked 500..5000 ms", RunDwell(false, true), 5000 + DWELL_BEAM_CLEAR_MS);
+
+  /* 사람이 짧게 지나감: 풀린 시점부터 DWELL_BEAM_CLEAR_MS (기본보다 빠를 수 있음) */
+  Fake(200, 400);
+  Expect("beam crossed 200..400 ms", RunDwell(false, true), 400 + DWELL_BEAM_CLEAR_MS);
+
+  /* 빔 센서를 꺼 두면 끊김 입력을 무시 (Beam_IsBlocked()가 false) */
+  Fake(500, 5000);
+  Expect("beam disabled", RunDwell(false, false), DWELL_CAR_IDLE_MS);
+
+  /* 5) 닫히는 중 빔 끊김 -> 되열기, CLOSE 잠금 */
+  Dwell_GetStats(&st);
+  uint32_t reopen0 = st.beamReopen;
+  CHECK(!Dwell_ShouldReopen(false), "reopen without beam break");
+  CHECK(Dwell_ShouldReopen(true), "no reopen on beam break");
+  CHECK(Dwell_CanClose(false), "CLOSE refused with clear beam");
+  CHECK(!Dwell_CanClose(true), "CLOSE accepted while beam blocked");
+
+  /* CLOSE 버튼으로 닫기 통계 */
+  Dwell_Begin(0, false, true, s_seq);
+  Dwell_Task(300, false, s_seq);
+  CHECK(Dwell_End(300, true) == 300, "close button dwell length");
+
+  /* 6) 통계 */
+  Dwell_GetStats(&st);
+  printf("\nstats: N=%u min=%u max=%u short=%u ext=%u hall=%u close=%u cross=%u reopen=%u\n",
+         st.count, st.minMs, st.maxMs, st.shortened, st.extended, st.hallStops, st.closeBtn,
+         st.beamCross, st.beamReopen);
+  CHECK(st.count == 13, "count %u", st.count);
+  CHECK(st.minMs == 300 && st.maxMs == DWELL_MAX_MS, "min %u max %u", st.minMs, st.maxMs);
+  /* 창이 지난 뒤 호출로 다시 늘어난 대기(1800 ms)는 단축으로 분류된다 */
+  CHECK(st.shortened == 4, "shortened %u", st.shortened);
+  CHECK(st.extended == 3, "extended %u", st.extended);
+  CHECK(st.hallStops == 2, "hall stops %u", st.hallStops);
+  CHECK(st.closeBtn == 1, "close button %u", st.closeBtn);
+  CHECK(st.beamCross == 2, "beam cross %u", st.beamCross);
+  CHECK(st.beamReopen == reopen0 + 1, "beam reopen %u", st.beamReopen);
+
+  Dwell_ResetStats();
+  Dwell_GetStats(&st);
+  CHECK(st.count == 0 && st.beamReopen == 0, "reset left count %u", st.count);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,143 @@
+/*
+ * test_elevator.c
+ *
+ *  엘리베이터 FSM(elevator.c)을 가짜 승강로/문/버튼(fake_car.c)과 실제 스텝모터 드라이버로 검사
+ *  - 레벨링 중 EMG -> RESUME 뒤 다음 이동이 목표층에서 레벨링 후 정지하는지
+ *    (중단된 레벨링 상태가 남으면 목표층을 지나쳐 MOVE_TIMEOUT까지 달린다)
+ *  - 이동 중 받은 DRIVE/PROFILE 변경 요청이 카가 IDLE로 돌아온 뒤에야 적용되는지
+ *  - 이동 중 OPEN 버튼은 무시되는지 (IDLE에서는 문을 연다)
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "fake_car.h"
+#include "elevator.h"
+#include "button.h"
+
+#define RUN_LIMIT_MS  40000
+
+/* 조건이 참이 될 때까지 루프, 시간 초과면 false */
+static bool RunUntil(bool (*cond)(void), uint32_t limitMs)
+{
+  uint32_t end = FakeCar_Ms() + limitMs;
+  while (FakeCar_Ms() < end)
+  {
+    if (cond()) return true;
+    FakeCar_Loop();
+  }
+  return cond();
+}
+
+static bool LevelingAt2(void)
+{
+  return Elevator_GetState() == ELEVATOR_MOVING_UP && FakeCar_InWindow(2);
+}
+static bool Stopped(void) { return !Stepper_IsBusy(&hstepper1); }
+static bool DoorWaitAt3(void)
+{
+  return Elevator_GetState() == ELEVATOR_DOOR_WAIT && Elevator_GetCurrentFloor() == 3;
+}
+static bool Idle(void) { return Elevator_GetState() == ELEVATOR_IDLE; }
+static bool Moving(void) { return Elevator_GetState() == ELEVATOR_MOVING_UP && Stepper_IsBusy(&hstepper1); }
+
+
+static void EmgDuringLevelingThenResume(void)
+{
+  printf("-- EMG during leveling, RESUME, next trip --\n");
+  FakeCar_Init();
+
+  /* 1층 -> 2층: 2층 창에 들어와 레벨링(감속 정지) 중에 EMG */
+  Elevator_RequestCar(2);
+  CHECK(RunUntil(LevelingAt2, RUN_LIMIT_MS), "never reached the floor 2 window");
+  for (int i = 0; i < 20; i++) FakeCar_Loop();   // StartLeveling -> 감속 정지 진행 중
+  CHECK(Stepper_IsBusy(&hstepper1), "car already stopped before EMG");
+  FakeCar_Press(BTN_EMG);
+  FakeCar_Loop();
+  CHECK(Elevator_GetState() == ELEVATOR_EMG, "EMG not entered (state %d)", Elevator_GetState());
+  CHECK(RunUntil(Stopped, RUN_LIMIT_MS), "EMG stop did not finish");
+
+  /* 정리(Elevator_Task)가 돌기 전 RESUME은 무시될 수 있으므로 루프를 조금 돌린 뒤 */
+  for (int i = 0; i < 5; i++) FakeCar_Loop();
+  Elevator_ResumeFromEMG();
+  CHECK(Elevator_GetState() == ELEVATOR_IDLE, "RESUME refused (state %d)", Elevator_GetState());
+
+  /* 다음 이동: 3층 호출 -> (남은 2층 호출을 먼저 처리한 뒤) 3층 창 안에서 정지하고 문이 열려야 함 */
+  Elevator_RequestCar(3);
+  CHECK(RunUntil(DoorWaitAt3, RUN_LIMIT_MS), "3rd floor trip never reached DOOR_WAIT (state %d)",
+        Elevator_GetState());
+  CHECK(FakeCar_InWindow(3), "stopped at %d, outside the floor 3 window",
+        Stepper_GetPosition(&hstepper1));
+  CHECK(Elevator_GetCurrentFloor() == 3, "current floor %u", Elevator_GetCurrentFloor());
+  CHECK(fake_car.opensFast == 0, "door opened %u times while moving fast", fake_car.opensFast);
+
+  /* 문 닫힘까지 정상 순환 */
+  CHECK(RunUntil(Idle, RUN_LIMIT_MS), "door cycle did not return to IDLE");
+  printf("stopped at %d (floor 3 centre %d)\n", Stepper_GetPosition(&hstepper1), FAKE_FLOOR_POS(3));
+}
+
+
+static void SettingRequestsWaitForIdle(void)
+{
+  printf("-- DRIVE/PROFILE request while moving --\n");
+  FakeCar_Init();
+
+  Elevator_RequestCar(2);
+  CHECK(RunUntil(Moving, RUN_LIMIT_MS), "trip did not start");
+
+  /* UART ISR 대신 직접 요청: 이동/문 동작 중에는 그대로 HALF */
+  CHECK(Elevator_RequestDriveMode(STEPPER_DRIVE_FULL), "request refused");
+  CHECK(!Elevator_RequestDriveMode((stepper_drive_t)(STEPPER_DRIVE_WAVE + 1)), "bad mode accepted");
+  stepper_profile_t prof0 = Stepper_GetProfileMode(&hstepper1);
+  stepper_profile_t prof1 = (prof0 == STEPPER_PROFILE_SCURVE) ? STEPPER_PROFILE_TRAPEZOID : STEPPER_PROFILE_SCURVE;
+  CHECK(Elevator_RequestProfileMode(prof1), "profile request refused");
+  bool changedEarly = false;
+  while (FakeCar_Ms() < RUN_LIMIT_MS && !Idle())
+  {
+    FakeCar_Loop();
+    if (!Idle() && (Stepper_GetDriveMode(&hstepper1) != STEPPER_DRIVE_HALF ||
+                    Stepper_GetProfileMode(&hstepper1) != prof0)) changedEarly = true;
+  }
+  CHECK(!changedEarly, "drive mode changed before the car was IDLE");
+  CHECK(Idle(), "car did not return to IDLE");
+
+  /* IDLE 다음 루프에서 적용 */
+  FakeCar_Loop();
+  CHECK(Stepper_GetDriveMode(&hstepper1) == STEPPER_DRIVE_FULL, "drive mode %d after IDLE",
+        Stepper_GetDriveMode(&hstepper1));
+  CHECK(Stepper_GetProfileMode(&hstepper1) == prof1, "profile %d after IDLE", Stepper_GetProfileMode(&hstepper1));
+}
+
+
+static void OpenButtonIgnoredWhileMoving(void)
+{
+  printf("-- OPEN button while moving --\n");
+  FakeCar_Init();
+
+  Elevator_RequestCar(3);
+  CHECK(RunUntil(Moving, RUN_LIMIT_MS), "trip did not start");
+  for (int i = 0; i < 200; i++) FakeCar_Loop();   // 가속 후 등속 구간
+
+  FakeCar_Press(BTN_OPEN);
+  FakeCar_Loop();
+  CHECK(Elevator_GetState() == ELEVATOR_MOVING_UP, "OPEN changed state to %d while moving", Elevator_GetState());
+  CHECK(!fake_car.doorOpen, "door opened while moving");
+
+  CHECK(RunUntil(DoorWaitAt3, RUN_LIMIT_MS), "trip to 3 did not finish");
+  CHECK(fake_car.opensFast == 0, "door opened %u times while moving fast", fake_car.opensFast);
+  CHECK(RunUntil(Idle, RUN_LIMIT_MS), "door cycle did not return to IDLE");
+
+  /* 정지(IDLE)에서는 OPEN으로 문이 열림 */
+  FakeCar_Press(BTN_OPEN);
+  FakeCar_Loop();
+  FakeCar_Loop();
+  CHECK(fake_car.doorOpen, "OPEN in IDLE did not open the door (state %d)", Elevator_GetState());
+}
+
+
+int main(void)
+{
+  EmgDuringLevelingThenResume();
+  SettingRequestsWaitForIdle();
+  OpenButtonIgnoredWhileMoving();
+  return HOST_TEST_RESULT();
+}
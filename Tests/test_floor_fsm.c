@@ -0,0 +1,70 @@
+/*
+ * test_floor_fsm.c
+ *
+ *  포토 RAW 디코더(floor_fsm.c) 전수 검사
+ *  - RAW 2^N 조합 모두를 승강로 배치 규칙으로 만든 기대값과 비교
+ *    (센서 1개 = 그 층, 이웃한 2개 = 층 사이, 없음 = 이동중, 나머지 = PF_ERROR)
+ *  - RAW 상위 비트(센서 외)는 무시되는지
+ *  - 층 번호/표시 문자열 보조 함수
+ */
+
+#include "host_test.h"
+#include "floor_fsm.h"
+#include <string.h>
+
+#define RAW_N  (1U << FLOOR_FSM_SENSORS)
+
+/* 배치 규칙에 따른 기대 상태 (floor_fsm.c의 표와 독립적으로 계산) */
+static photo_fsm_t Expected(uint8_t raw)
+{
+  static const photo_fsm_t floorState[FLOOR_FSM_SENSORS]     = { PF_F1, PF_F2, PF_F3 };
+  static const photo_fsm_t betweenState[FLOOR_FSM_SENSORS - 1] = { PF_MOVE_1_2, PF_MOVE_2_3 };
+
+  if (raw == 0) return PF_UNKNOWN;
+
+  for (uint8_t f = 0; f < FLOOR_FSM_SENSORS; f++)
+  {
+    if (raw == (1U << f)) return floorState[f];
+    if (f + 1 < FLOOR_FSM_SENSORS && raw == (3U << f)) return betweenState[f];
+  }
+  return PF_ERROR;
+}
+
+int main(void)
+{
+  uint32_t valid = 0, error = 0;
+
+  FloorFSM_Init();
+
+  for (uint32_t r = 0; r < RAW_N; r++)
+  {
+    photo_fsm_t want = Expected((uint8_t)r);
+    photo_fsm_t got  = FloorFSM_Decode((uint8_t)r);
+
+    printf("RAW %u%u%u -> %-9s (expect %s)\n", (r >> 2) & 1, (r >> 1) & 1, r & 1,
+           FloorFSM_ToString(got), FloorFSM_ToString(want));
+    CHECK(got == want, "RAW 0x%X: %d, expected %d", r, got, want);
+    if (want == PF_ERROR) error++; else valid++;
+
+    /* 센서 외 상위 비트는 무시 */
+    for (uint32_t hi = RAW_N; hi < 0x100; hi += RAW_N)
+      CHECK(FloorFSM_Decode((uint8_t)(r | hi)) == got, "RAW 0x%X: high bits change the result", r | hi);
+  }
+  printf("%u valid patterns, %u PF_ERROR\n", valid, error);
+  CHECK(valid == 2 * FLOOR_FSM_SENSORS, "valid patterns %u", valid);
+
+  /* 층 번호: 확정층만 1~N, 나머지 0 */
+  for (int s = 0; s < PF_COUNT; s++)
+  {
+    uint8_t f = FloorFSM_FloorOf((photo_fsm_t)s);
+    uint8_t want = (s >= PF_F1 && s <= PF_F3) ? (uint8_t)(s - PF_F1 + 1) : 0;
+    CHECK(f == want, "FloorOf(%d) = %u, expected %u", s, f, want);
+
+    const char *name = FloorFSM_ToString((photo_fsm_t)s);
+    CHECK(name && strcmp(name, "?") != 0, "state %d has no name", s);
+  }
+  CHECK(FloorFSM_FloorOf(PF_COUNT) == 0, "FloorOf out of range");
+  CHECK(strcmp(FloorFSM_ToString(PF_COUNT), "?") == 0, "ToString out of range");
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,159 @@
+/*
+ * test_phase_cost.c
+ *
+ *  phase 출력: 기존 HAL_GPIO_WritePin x4 방식 vs BSRR 워드 방식
+ *
+ *  1) 동작 검사: 8개 phase 모두에서 BSRR 워드가 만드는 코일 상태가
+ *     HALF_STEP_SEQ(= 기존 HAL 경로 출력)와 같은지 확인
+ *  1-1) 주차(POWER_OFF) 중 벤치 후 코일이 다시 모두 꺼지는지
+ *  2) 사이클 비용 모델: 한 스텝 출력에 드는 명령 수를 Cortex-M4 명령 사이클로 환산
+ *     (플래시 wait state/파이프라인 재충전은 분기마다 P 사이클로 근사)
+ *
+ *  실측은 타깃에서 UART "BENCH" 명령(Stepper_BenchPhaseOutput, DWT CYCCNT)으로 한다.
+ *  이 모델은 그 값이 어느 정도여야 하는지의 기준이다.
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "stepper.h"
+
+/* Cortex-M4 명령 사이클 (ARM DDI 0439 기준, P = 파이프라인 재충전 근사) */
+#define CYC_P        2    // 분기 시 재충전(100MHz, 3 wait state 플래시 + ART 적중 가정)
+#define CYC_LDR      2
+#define CYC_STR      1    // 연속 store는 버퍼링되어 1
+#define CYC_ALU      1
+#define CYC_BL       (1 + CYC_P)
+#define CYC_BX       (1 + CYC_P)
+#define CYC_BRANCH   (1 + CYC_P)
+
+/* HAL_GPIO_WritePin 1회: 인자 준비(포트/핀 ldr 2, 상태 표 ldr+cmp) + 호출 + 본문 + 복귀
+ * 본문(USE_FULL_ASSERT off): cmp PinState, 분기, (lsl), str BSRR */
+#define HAL_CALL_CYCLES  (3 * CYC_LDR + CYC_ALU            /* 인자 준비 */          \
+                          + CYC_BL                          /* 호출 */               \
+                          + CYC_ALU + CYC_BRANCH + CYC_ALU + CYC_STR  /* 본문 */     \
+                          + CYC_BX)                         /* 복귀 */
+/* 핀 루프 1회 오버헤드(증가/비교/분기) */
+#define LOOP_CYCLES      (2 * CYC_ALU + CYC_BRANCH)
+
+/* BSRR 방식 포트 1개: 워드 ldr, 포트 포인터 ldr, str BSRR + 루프 */
+#define BSRR_PORT_CYCLES (2 * CYC_LDR + CYC_STR)
+
+static stepper_t s_m;
+
+static void InitMotor(const stepper_hw_t *hw)
+{
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  Stepper_Init(&s_m, hw);
+}
+
+/* 마지막 BSRR 쓰기로부터 코일 i의 출력 상태 */
+static int CoilFromBsrr(const stepper_hw_t *hw, uint8_t i)
+{
+  uint32_t w = hw->port[i]->BSRR;
+  if (w & hw->pin[i]) return 1;
+  if (w & ((uint32_t)hw->pin[i] << 16)) return 0;
+  return -1;   // 이 코일을 쓰지 않음(오류)
+}
+
+static void CheckPhases(const char *name, const stepper_hw_t *hw)
+{
+  static const uint8_t seq[8][4] =
+  {
+    {1,0,0,0}, {1,1,0,0}, {0,1,0,0}, {0,1,1,0},
+    {0,0,1,0}, {0,0,1,1}, {0,0,0,1}, {1,0,0,1}
+  };
+
+  InitMotor(hw);
+
+  for (uint8_t k = 1; k <= 8; k++)
+  {
+    Stepper_MoveProfile(&s_m, DIR_UP, 1);
+    while (HostTim4_Run(NULL)) { }
+
+    uint8_t ph = k & 0x07;
+
+    /* 같은 phase를 기존 HAL 경로로 한 번 더 써서 ODR에 남김 */
+    for (uint8_t p = 0; p < HOST_GPIO_PORTS; p++) host_gpio[p].ODR = 0;
+    uint32_t writes = host_gpio_writes;
+    Stepper_BenchPhaseOutput(&s_m, 1, NULL, NULL);
+    CHECK(host_gpio_writes - writes == 4, "%s: HAL path wrote %u pins", name, host_gpio_writes - writes);
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      int bsrr = CoilFromBsrr(hw, i);
+      int hal  = (hw->port[i]->ODR & hw->pin[i]) ? 1 : 0;
+      CHECK(bsrr == seq[ph][i], "%s phase %u IN%u: bsrr %d, expected %u", name, ph, i + 1, bsrr, seq[ph][i]);
+      CHECK(hal == seq[ph][i], "%s phase %u IN%u: hal %d, expected %u", name, ph, i + 1, hal, seq[ph][i]);
+    }
+  }
+}
+
+static void CheckBenchRestoresOff(const char *name, const stepper_hw_t *hw)
+{
+  InitMotor(hw);
+
+  Stepper_MoveProfile(&s_m, DIR_UP, 1);
+  while (HostTim4_Run(NULL)) { }
+
+  /* 정지 -> HOLD -> 주차(OFF) */
+  Stepper_SetParked(&s_m, true);
+  for (uint32_t i = 0; i < 5000 && Stepper_GetPowerState(&s_m) != STEPPER_POWER_OFF; i++)
+  {
+    host_tick++;
+    Stepper_Task(&s_m);
+  }
+  CHECK(Stepper_GetPowerState(&s_m) == STEPPER_POWER_OFF, "%s: not parked", name);
+
+  CHECK(Stepper_BenchPhaseOutput(&s_m, 10, NULL, NULL), "%s: bench refused", name);
+  for (uint8_t i = 0; i < 4; i++)
+    CHECK(CoilFromBsrr(hw, i) == 0, "%s: IN%u left on after bench while parked", name, i + 1);
+}
+
+static void CostModel(const char *name, const stepper_hw_t *hw, uint8_t expectPorts)
+{
+  InitMotor(hw);
+
+  uint32_t halCyc  = 4 * (HAL_CALL_CYCLES + LOOP_CYCLES);
+  uint32_t bsrrCyc = s_m.portCount * (BSRR_PORT_CYCLES + LOOP_CYCLES);
+
+  printf("%-12s ports %u | HAL x4: %3u cyc, 4 stores at 4 instants | BSRR: %3u cyc, %u stores | %.1fx\n",
+         name, s_m.portCount, halCyc, bsrrCyc, s_m.portCount, (double)halCyc / bsrrCyc);
+
+  /* 1400 sps(TUNE_CRUISE_MAX)에서 100MHz 기준 ISR 부하 중 phase 출력 몫 */
+  printf("%-12s @1400 sps: HAL %.3f%%  BSRR %.3f%% of 100 MHz\n", "",
+         halCyc * 1400.0 / 1e6, bsrrCyc * 1400.0 / 1e6);
+
+  CHECK(s_m.portCount == expectPorts, "%s: port count %u", name, s_m.portCount);
+  CHECK(bsrrCyc < halCyc, "%s: BSRR not cheaper", name);
+}
+
+
+int main(void)
+{
+  /* 보드 배선(IN1=PA4, IN2=PB0, IN3=PC1, IN4=PC0): 포트 3개 */
+  const stepper_hw_t board =
+  {
+    .port = { GPIOA, GPIOB, GPIOC, GPIOC },
+    .pin  = { GPIO_PIN_4, GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_0 },
+    .channel = TIM_CHANNEL_1,
+  };
+  /* 한 포트에 모두 배선한 경우: store 1번 */
+  const stepper_hw_t onePort =
+  {
+    .port = { GPIOB, GPIOB, GPIOB, GPIOB },
+    .pin  = { GPIO_PIN_12, GPIO_PIN_13, GPIO_PIN_14, GPIO_PIN_15 },
+    .channel = TIM_CHANNEL_1,
+  };
+
+  CheckPhases("board", &board);
+  CheckPhases("one-port", &onePort);
+  CheckBenchRestoresOff("board", &board);
+  CheckBenchRestoresOff("one-port", &onePort);
+
+  printf("\nphase output cost model (Cortex-M4, P=%u)\n", CYC_P);
+  CostModel("board", &board, 3);
+  CostModel("one-port", &onePort, 1);
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+/*
+ * test_stepper_dma.c
+ *
+ *  DMA 타이밍 모드 검사: 같은 이동을 ISR 방식과 DMA 방식(CH1 + circular 버퍼)으로 돌려
+ *  스텝 시각열이 한 스텝도 다르지 않은지 확인한다.
+ *  - 프로파일 이동(사다리꼴/S-curve), 크립 이동
+ *  - 연속 회전 중 감속 정지 / 비상 감속 (DMA 순서화를 끊고 ISR로 넘기는 경로)
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "stepper.h"
+#include <string.h>
+
+#define MAX_STEPS  4000
+
+typedef enum { RUN_PROFILE, RUN_CREEP, RUN_DECEL, RUN_EMG } run_t;
+
+static stepper_t s_m;
+static uint64_t  s_times[2][MAX_STEPS];
+
+static const stepper_hw_t s_hw =
+{
+  .port    = { GPIOA, GPIOB, GPIOC, GPIOC },
+  .pin     = { GPIO_PIN_4, GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_0 },
+  .channel = TIM_CHANNEL_1,
+};
+
+/* 이동 하나를 돌려 스텝 시각을 기록, 스텝 수 반환 */
+static uint32_t Record(bool dma, stepper_profile_t mode, run_t run, uint64_t *out)
+{
+  uint32_t n = 0;
+
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  Stepper_Init(&s_m, &s_hw);
+  Stepper_SetProfileMode(&s_m, mode);
+  CHECK(Stepper_SetDmaMode(&s_m, dma), "SetDmaMode(%d) refused", dma);
+
+  switch (run)
+  {
+    case RUN_PROFILE: Stepper_MoveProfile(&s_m, DIR_UP, 1500); break;
+    case RUN_CREEP:   Stepper_MoveToCreep(&s_m, 900, DIR_UP);  break;
+    default:          Stepper_StartContinuous(&s_m, DIR_DOWN); break;
+  }
+  if (dma) CHECK(s_m.dmaActive, "DMA sequencing did not start");
+
+  while (n < MAX_STEPS && HostTim4_Run(NULL))
+  {
+    out[n++] = HostTim4_Now();
+
+    if (run == RUN_CREEP && n == 1200) Stepper_Decelerate(&s_m);   // 크립 중 정지
+    if (run == RUN_DECEL && n == 700)  Stepper_Decelerate(&s_m);   // 등속 중 감속 정지
+    if (run == RUN_EMG   && n == 700)  Stepper_EmergencyStop(&s_m, STEPPER_EMG_MAX_STEPS);
+  }
+
+  CHECK(!Stepper_IsBusy(&s_m), "run %d still busy after %u steps", run, n);
+  CHECK(!s_m.dmaActive, "DMA still active after stop");
+  return n;
+}
+
+static void Compare(stepper_profile_t mode, run_t run, const char *name)
+{
+  uint32_t nIsr = Record(false, mode, run, s_times[0]);
+  uint32_t nDma = Record(true,  mode, run, s_times[1]);
+
+  uint32_t diff = 0;
+  for (uint32_t i = 0; i < nIsr && i < nDma; i++)
+    if (s_times[0][i] != s_times[1][i]) { diff = i + 1; break; }
+
+  printf("%-7s %-8s steps ISR %4u DMA %4u  %s\n", mode == STEPPER_PROFILE_SCURVE ? "SCURVE" : "TRAP",
+         name, nIsr, nDma, diff ? "MISMATCH" : "identical");
+
+  CHECK(nIsr == nDma, "%s: step count %u vs %u", name, nIsr, nDma);
+  CHECK(diff == 0, "%s: first different step %u", name, diff);
+}
+
+
+int main(void)
+{
+  static const char *const names[] = { "profile", "creep", "decel", "emg" };
+
+  for (int mode = STEPPER_PROFILE_TRAPEZOID; mode <= STEPPER_PROFILE_SCURVE; mode++)
+    for (int run = RUN_PROFILE; run <= RUN_EMG; run++)
+      Compare((stepper_profile_t)mode, (run_t)run, names[run]);
+
+  return HOST_TEST_RESULT();
+}
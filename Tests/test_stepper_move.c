@@ -0,0 +1,83 @@
+/*
+ * test_stepper_move.c
+ *
+ *  이동 API의 half-step -> 모터 스텝 변환 검사.
+ *  MoveProfile(거리)/MoveTo(절대)/MoveToCreep(절대)가 같은 half-step 거리에 대해
+ *  같은 스텝 수를 내는지, 드라이브 모드별(HALF/FULL/WAVE)로 홀수/짝수 거리를 모두 본다.
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "stepper.h"
+
+static stepper_t s_m;
+
+static const stepper_hw_t s_hw =
+{
+  .port    = { GPIOA, GPIOB, GPIOC, GPIOC },
+  .pin     = { GPIO_PIN_4, GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_0 },
+  .channel = TIM_CHANNEL_1,
+};
+
+typedef enum { API_PROFILE, API_MOVETO, API_CREEP } api_t;
+
+/* 현재 위치에서 half-step 거리 d만큼 위로 이동, 실제 스텝 수 반환
+ * (FULL/WAVE 전환 시 phase 정렬로 위치가 1 바뀔 수 있어 목표는 시작 위치 기준) */
+static uint32_t Run(stepper_drive_t drive, api_t api, uint32_t d, int32_t *moved)
+{
+  uint32_t n = 0;
+
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  Stepper_Init(&s_m, &s_hw);
+  CHECK(Stepper_SetDriveMode(&s_m, drive), "SetDriveMode(%d) refused", drive);
+  int32_t start = s_m.position;
+
+  switch (api)
+  {
+    case API_PROFILE: Stepper_MoveProfile(&s_m, DIR_UP, d);            break;
+    case API_MOVETO:  Stepper_MoveTo(&s_m, start + (int32_t)d);              break;
+    case API_CREEP:   Stepper_MoveToCreep(&s_m, start + (int32_t)d, DIR_UP); break;
+  }
+  /* 크립은 목표에서 감속 정지하지 않고 계속 돈다 -> 목표 스텝 수까지만 센다 */
+  while (HostTim4_Run(NULL))
+  {
+    n++;
+    if (api == API_CREEP && n == s_m.stepsTotal) { Stepper_Stop(&s_m); break; }
+  }
+  if (moved) *moved = s_m.position - start;
+  return n;
+}
+
+int main(void)
+{
+  static const char *const names[] = { "HALF", "FULL", "WAVE" };
+  static const uint32_t dist[] = { 1, 2, 3, 7, 64, 65, 301 };
+
+  for (int drive = STEPPER_DRIVE_HALF; drive <= STEPPER_DRIVE_WAVE; drive++)
+  {
+    uint32_t stride = (drive == STEPPER_DRIVE_HALF) ? 1 : 2;
+
+    for (size_t k = 0; k < sizeof(dist) / sizeof(dist[0]); k++)
+    {
+      uint32_t d      = dist[k];
+      uint32_t expect = (d + stride / 2) / stride;
+      int32_t  pProf;
+      uint32_t nProf  = Run((stepper_drive_t)drive, API_PROFILE, d, &pProf);
+      uint32_t nTo    = Run((stepper_drive_t)drive, API_MOVETO, d, NULL);
+      uint32_t nCreep = Run((stepper_drive_t)drive, API_CREEP, d, NULL);
+
+      printf("%s d=%3u  profile %3u  moveto %3u  creep %3u  (moved %d)\n",
+             names[drive], d, nProf, nTo, nCreep, pProf);
+
+      CHECK(nProf == expect, "%s d=%u: MoveProfile %u steps, expected %u", names[drive], d, nProf, expect);
+      CHECK(nTo == expect, "%s d=%u: MoveTo %u steps, expected %u", names[drive], d, nTo, expect);
+      CHECK(nCreep == expect, "%s d=%u: MoveToCreep %u steps, expected %u", names[drive], d, nCreep, expect);
+      /* 짝수 거리는 정확히 도달, 홀수 거리는 FULL/WAVE에서 1 half-step 지나침 */
+      CHECK(pProf == (int32_t)(expect * stride), "%s d=%u: position %d", names[drive], d, pProf);
+      if (d % 2 == 0) CHECK(pProf == (int32_t)d, "%s d=%u: even target missed (%d)", names[drive], d, pProf);
+    }
+  }
+
+  return HOST_TEST_RESULT();
+}
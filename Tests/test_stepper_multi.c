@@ -0,0 +1,182 @@
+/*
+ * test_stepper_multi.c
+ *
+ *  stepper_t 여러 개를 TIM4 CH1/CH3/CH4에 나눠 동시에 돌려 상태가 서로 섞이지 않는지 검사
+ *  - 모터마다 다른 포트/프로파일/드라이브 모드/이동으로 각각 혼자 돌린 스텝 시각열을 기록
+ *  - 셋을 같은 시각에 출발시켜 한 타이머에서 동시에 돌린 결과가 혼자 돌린 것과 같은지
+ *    (스텝 시각, 최종 위치, phase, 코일 출력 포트)
+ *  - 정지 후 감전류 홀드: CH2 초핑 하나를 세 모터가 같이 쓰고, 다시 움직이는 모터는 빠짐
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "stepper.h"
+#include <string.h>
+
+#define NMOT       3
+#define MAX_STEPS  3000
+
+typedef struct
+{
+  const char        *name;
+  stepper_hw_t       hw;
+  uint16_t           mask;       // 이 모터의 코일 핀(한 포트)
+  stepper_profile_t  profile;
+  stepper_drive_t    drive;
+  uint8_t            dir;
+  uint32_t           steps;      // 0이면 연속 회전 후 decelAt 스텝에서 감속 정지
+  uint32_t           decelAt;
+} motor_cfg_t;
+
+/* DMA 주소 확장(host_hal.c) 때문에 stepper_t는 static이어야 한다 */
+static stepper_t s_m[NMOT];
+
+static const motor_cfg_t s_cfg[NMOT] =
+{
+  { "A/CH1", { .port = { GPIOB, GPIOB, GPIOB, GPIOB },
+               .pin  = { GPIO_PIN_12, GPIO_PIN_13, GPIO_PIN_14, GPIO_PIN_15 },
+               .channel = TIM_CHANNEL_1 }, 0xF000,
+    STEPPER_PROFILE_TRAPEZOID, STEPPER_DRIVE_HALF, DIR_UP, 1200, 0 },
+  { "B/CH3", { .port = { GPIOD, GPIOD, GPIOD, GPIOD },
+               .pin  = { GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_2, GPIO_PIN_3 },
+               .channel = TIM_CHANNEL_3 }, 0x000F,
+    STEPPER_PROFILE_SCURVE, STEPPER_DRIVE_HALF, DIR_DOWN, 800, 0 },
+  { "C/CH4", { .port = { GPIOE, GPIOE, GPIOE, GPIOE },
+               .pin  = { GPIO_PIN_8, GPIO_PIN_9, GPIO_PIN_10, GPIO_PIN_11 },
+               .channel = TIM_CHANNEL_4 }, 0x0F00,
+    STEPPER_PROFILE_TRAPEZOID, STEPPER_DRIVE_FULL, DIR_UP, 0, 500 },
+};
+
+static uint64_t s_alone[NMOT][MAX_STEPS];
+static uint64_t s_multi[NMOT][MAX_STEPS];
+static uint32_t s_nAlone[NMOT], s_nMulti[NMOT];
+static int32_t  s_posAlone[NMOT];
+static uint8_t  s_phAlone[NMOT];
+
+static uint8_t ChIdx(uint8_t k) { return (uint8_t)(s_cfg[k].hw.channel / 4U); }
+
+static void Setup(uint8_t k)
+{
+  const motor_cfg_t *c = &s_cfg[k];
+
+  CHECK(Stepper_Init(&s_m[k], &c->hw), "%s: Init refused", c->name);
+  Stepper_SetProfileMode(&s_m[k], c->profile);
+  Stepper_SetDriveMode(&s_m[k], c->drive);
+}
+
+static void Start(uint8_t k)
+{
+  const motor_cfg_t *c = &s_cfg[k];
+
+  if (c->steps) Stepper_MoveProfile(&s_m[k], c->dir, c->steps);
+  else          Stepper_StartContinuous(&s_m[k], c->dir);
+}
+
+/* 일치한 채널의 스텝 기록, 연속 회전 모터는 decelAt에서 감속 정지 */
+static void OnStep(uint8_t ch, uint64_t times[NMOT][MAX_STEPS], uint32_t n[NMOT])
+{
+  for (uint8_t k = 0; k < NMOT; k++)
+  {
+    if (ChIdx(k) != ch || n[k] >= MAX_STEPS) continue;
+    times[k][n[k]++] = HostTim4_Now();
+    if (s_cfg[k].decelAt && n[k] == s_cfg[k].decelAt) Stepper_Decelerate(&s_m[k]);
+  }
+}
+
+static uint16_t CoilsOn(uint8_t k)
+{
+  return (uint16_t)(s_cfg[k].hw.port[0]->BSRR & s_cfg[k].mask);
+}
+
+
+int main(void)
+{
+  uint8_t ch;
+
+  /* 1) 각 모터 혼자 */
+  for (uint8_t k = 0; k < NMOT; k++)
+  {
+    HostHal_Reset();
+    host_tim4_irq = Stepper_OnTimerIrq;
+    Setup(k);
+    Start(k);
+    while (HostTim4_Run(&ch)) OnStep(ch, s_alone, s_nAlone);
+    s_posAlone[k] = Stepper_GetPosition(&s_m[k]);
+    s_phAlone[k]  = s_m[k].stepIndex;
+  }
+
+  /* 2) 셋 동시에 (같은 시각 출발) */
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  for (uint8_t k = 0; k < NMOT; k++) Setup(k);
+  uint32_t otherWrites[NMOT] = { 0 };
+  for (uint8_t k = 0; k < NMOT; k++) Start(k);
+  while (HostTim4_Run(&ch))
+  {
+    OnStep(ch, s_multi, s_nMulti);
+
+    /* 각 모터 포트에는 그 모터의 핀만 쓰였는지 (다른 인스턴스의 phase가 섞이지 않음) */
+    for (uint8_t k = 0; k < NMOT; k++)
+      if (ChIdx(k) != ch && (s_cfg[k].hw.port[0]->BSRR & ~((uint32_t)s_cfg[k].mask * 0x10001U)))
+        otherWrites[k]++;
+  }
+
+  printf("motor  steps alone/multi  pos alone/multi  phase alone/multi\n");
+  for (uint8_t k = 0; k < NMOT; k++)
+  {
+    uint32_t diff = 0;
+    for (uint32_t i = 0; i < s_nAlone[k] && i < s_nMulti[k]; i++)
+      if (s_alone[k][i] != s_multi[k][i]) { diff = i + 1; break; }
+
+    printf("%-6s %5u / %-5u       %6d / %-6d    %u / %u  %s\n", s_cfg[k].name,
+           s_nAlone[k], s_nMulti[k], s_posAlone[k], Stepper_GetPosition(&s_m[k]),
+           s_phAlone[k], s_m[k].stepIndex, diff ? "MISMATCH" : "identical");
+
+    CHECK(s_nAlone[k] == s_nMulti[k], "%s: %u steps alone, %u together", s_cfg[k].name, s_nAlone[k], s_nMulti[k]);
+    CHECK(diff == 0, "%s: first different step time %u", s_cfg[k].name, diff);
+    CHECK(s_posAlone[k] == Stepper_GetPosition(&s_m[k]), "%s: position differs", s_cfg[k].name);
+    CHECK(s_phAlone[k] == s_m[k].stepIndex, "%s: phase differs", s_cfg[k].name);
+    CHECK(otherWrites[k] == 0, "%s: foreign pins written %u times", s_cfg[k].name, otherWrites[k]);
+    CHECK(!Stepper_IsBusy(&s_m[k]), "%s: still busy", s_cfg[k].name);
+  }
+  CHECK(s_posAlone[0] == 1200 && s_posAlone[1] == -800, "A/B positions %d %d", s_posAlone[0], s_posAlone[1]);
+
+  /* 3) 감전류 홀드: 세 모터가 CH2 초핑 하나를 공유 */
+  for (int pass = 0; pass < 2; pass++)
+  {
+    host_tick += STEPPER_HOLD_SETTLE_MS;
+    for (uint8_t k = 0; k < NMOT; k++) Stepper_Task(&s_m[k]);
+  }
+  for (uint8_t k = 0; k < NMOT; k++)
+    CHECK(Stepper_GetPowerState(&s_m[k]) == STEPPER_POWER_REDUCED, "%s: not in reduced hold", s_cfg[k].name);
+  CHECK(HostTim4_ChannelOn(1), "chop channel not running");
+
+  uint32_t chops = 0, togetherOk = 0;
+  for (int i = 0; i < 8 && HostTim4_Run(&ch); i++)
+  {
+    if (ch != 1) continue;
+    chops++;
+    bool on = CoilsOn(0) != 0;
+    if ((CoilsOn(1) != 0) == on && (CoilsOn(2) != 0) == on) togetherOk++;
+  }
+  CHECK(chops == 8 && togetherOk == chops, "chop: %u events, %u in step", chops, togetherOk);
+
+  /* A만 다시 이동: 초핑에서 빠지고(코일 계속 ON), B/C는 계속 초핑 */
+  Stepper_MoveProfile(&s_m[0], DIR_DOWN, 200);
+  uint32_t aOffDuringMove = 0, bcToggles = 0;
+  uint16_t lastB = CoilsOn(1);
+  while (Stepper_IsBusy(&s_m[0]) && HostTim4_Run(&ch))
+  {
+    if (ch != 1) continue;
+    if (CoilsOn(0) == 0) aOffDuringMove++;
+    if (CoilsOn(1) != lastB) { bcToggles++; lastB = CoilsOn(1); }
+  }
+  CHECK(aOffDuringMove == 0, "A: chop switched coils off %u times while moving", aOffDuringMove);
+  CHECK(bcToggles > 0, "B: chop stopped while A moved");
+  CHECK(Stepper_GetPosition(&s_m[0]) == 1000, "A: position %d after second move", Stepper_GetPosition(&s_m[0]));
+  CHECK(Stepper_GetPosition(&s_m[1]) == s_posAlone[1], "B: moved while A ran");
+
+  printf("chop: %u shared events in step, B toggled %u times during A's move\n", togetherOk, bcToggles);
+
+  return HOST_TEST_RESULT();
+}
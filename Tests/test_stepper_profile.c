@@ -0,0 +1,233 @@
+/*
+ * test_stepper_profile.c
+ *
+ *  가감속 프로파일 모드별 벤치마크 + S-curve 고정소수점 테이블 정확도 검사
+ *
+ *  1) 모드별(CONSTANT/TRAPEZOID/SCURVE) 한 층 이동을 TIM4 시뮬레이션으로 실제 ISR에 돌려
+ *     스텝 시각열을 얻고, 부하 모델에 넣어 이동 시간과 탈조 여유(토크 여유율 최소값)를 낸다.
+ *  2) BuildSCurve(고정소수점 + Newton-Raphson 역수)가 만든 ramp[]를
+ *     같은 적분을 double로 계산한 기준 테이블과 전 구간(STEPPER_RAMP_MAX까지) 비교한다.
+ *
+ *  부하 모델 (half-step, sps 단위로 환산한 토크 수지)
+ *  - 속도 f에서 낼 수 있는 가속도  A_av(f) = A_STALL * (1 - f / F_MAX) - A_FRIC
+ *    (감속은 마찰이 돕는 방향이므로 + A_FRIC)
+ *  - 스텝 k의 요구 가속도 a_k = (f_k - f_{k-W}) / (t_k - t_{k-W}), W = ACCEL_WINDOW
+ *    (간격이 1us 단위로 반올림되어 있어 한 스텝 차분은 고속에서 양자화 잡음이 큼)
+ *  - 여유율 = 1 - |a_k| / A_av(f_k), 0 이하면 그 스텝에서 탈조
+ *  - 정지 상태에서 출발/정지하는 첫·마지막 스텝은 F_PULLIN 이하여야 함
+ *  상수는 28BYJ-48(5V, ULN2003) half-step 실측 범위에 맞춘 모델값이며,
+ *  절대값보다 모드 간 비교용이다.
+ */
+
+#include "host_hal.h"
+#include "host_test.h"
+#include "stepper.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define MODEL_F_PULLIN   450.0    // 정지에서 바로 출발/정지 가능한 최대 half-step 속도
+#define MODEL_F_MAX      1800.0   // 토크가 0이 되는 속도
+#define MODEL_A_STALL    8000.0   // 저속 토크를 가속도(sps/s)로 환산
+#define MODEL_A_FRIC     1500.0   // 마찰/카 불평형 부하
+
+#define ACCEL_WINDOW     4        // 가속도 산출 구간(스텝)
+#define TRIP_STEPS       2000     // 층간 거리(half-step)
+
+static stepper_t s_m;
+
+static const stepper_hw_t s_hw =
+{
+  .port    = { GPIOA, GPIOB, GPIOC, GPIOC },
+  .pin     = { GPIO_PIN_4, GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_0 },
+  .channel = TIM_CHANNEL_1,
+};
+
+typedef struct
+{
+  uint32_t steps;
+  double   tripS;        // 출발 ~ 마지막 스텝
+  double   minMargin;    // 최소 토크 여유율(음수면 탈조)
+  double   atSps;        // 최소 여유가 나온 속도
+  double   startSps;     // 첫 스텝 속도
+  double   stopSps;      // 마지막 스텝 속도
+} trip_result_t;
+
+
+static void ResetMotor(void)
+{
+  HostHal_Reset();
+  host_tim4_irq = Stepper_OnTimerIrq;
+  Stepper_Init(&s_m, &s_hw);
+}
+
+static double Available(double f, bool braking)
+{
+  double a = MODEL_A_STALL * (1.0 - f / MODEL_F_MAX);
+  return braking ? (a + MODEL_A_FRIC) : (a - MODEL_A_FRIC);
+}
+
+/* 한 번 이동하며 스텝 간격을 부하 모델에 통과시킨다 */
+static trip_result_t RunTrip(stepper_profile_t mode, uint16_t cruise, uint32_t steps)
+{
+  trip_result_t r = { 0 };
+  uint64_t t[ACCEL_WINDOW + 1] = { 0 };   // 최근 스텝 시각(링)
+  double   f[ACCEL_WINDOW + 1] = { 0 };   // 그 스텝의 속도
+  uint64_t prevT = 0;
+
+  ResetMotor();
+  Stepper_SetProfileMode(&s_m, mode);
+  Stepper_SetProfile(&s_m, STEPPER_START_SPS_DEFAULT, cruise, STEPPER_ACCEL_DEFAULT);
+  Stepper_MoveProfile(&s_m, DIR_UP, steps);
+
+  r.minMargin = 1.0;
+  while (HostTim4_Run(NULL))
+  {
+    uint64_t now = HostTim4_Now();
+    double fNow = 1e6 / (double)(now - prevT);
+
+    r.steps++;
+    uint32_t k = r.steps % (ACCEL_WINDOW + 1);
+    t[k] = now;
+    f[k] = fNow;
+
+    if (r.steps == 1) r.startSps = fNow;
+    if (r.steps > ACCEL_WINDOW)
+    {
+      uint32_t o = (r.steps - ACCEL_WINDOW) % (ACCEL_WINDOW + 1);
+      double a = (fNow - f[o]) / ((double)(now - t[o]) * 1e-6);
+      double av = Available(fNow, a < 0);
+      double margin = (av > 0) ? (1.0 - fabs(a) / av) : -1.0;
+      if (margin < r.minMargin) { r.minMargin = margin; r.atSps = fNow; }
+    }
+
+    r.stopSps = fNow;
+    prevT = now;
+  }
+
+  r.tripS = (double)prevT * 1e-6;
+
+  CHECK(r.steps == steps, "mode %d: %u steps, expected %u", mode, r.steps, steps);
+  CHECK(Stepper_GetPosition(&s_m) == (int32_t)steps, "mode %d: position %d", mode, (int)Stepper_GetPosition(&s_m));
+  CHECK(!Stepper_IsBusy(&s_m), "mode %d: still busy", mode);
+  return r;
+}
+
+
+/* ==============================
+ *   1) 모드별 이동 시간 / 탈조 여유
+ * ============================== */
+static const char *const s_modeName[] = { "CONST", "TRAP", "SCURVE" };
+
+static void BenchProfiles(void)
+{
+  static const uint16_t cruises[] = { STEPPER_CRUISE_SPS_DEFAULT, 1200, 1400 };
+
+  printf("\ntrip %u half-steps, start %u sps, accel %u sps/s, jerk %u sps/s^2\n",
+         TRIP_STEPS, STEPPER_START_SPS_DEFAULT, STEPPER_ACCEL_DEFAULT, STEPPER_JERK_DEFAULT);
+  printf("load model: pull-in %.0f, f_max %.0f, a_stall %.0f, a_fric %.0f\n",
+         MODEL_F_PULLIN, MODEL_F_MAX, MODEL_A_STALL, MODEL_A_FRIC);
+  printf("%-7s %-6s %8s %10s %10s %8s %8s\n", "cruise", "mode", "trip[s]", "margin[%]", "@sps", "start", "stop");
+
+  trip_result_t def[3];
+
+  for (unsigned c = 0; c < sizeof(cruises) / sizeof(cruises[0]); c++)
+  {
+    for (int mode = STEPPER_PROFILE_CONSTANT; mode <= STEPPER_PROFILE_SCURVE; mode++)
+    {
+      trip_result_t r = RunTrip((stepper_profile_t)mode, cruises[c], TRIP_STEPS);
+      printf("%-7u %-6s %8.3f %10.1f %10.0f %8.0f %8.0f\n", cruises[c], s_modeName[mode],
+             r.tripS, r.minMargin * 100.0, r.atSps, r.startSps, r.stopSps);
+
+      /* 모든 모드는 정지 상태에서 pull-in 이하로 출발/정지해야 함 */
+      CHECK(r.startSps <= MODEL_F_PULLIN, "%s start %.0f sps", s_modeName[mode], r.startSps);
+      CHECK(r.stopSps <= MODEL_F_PULLIN, "%s stop %.0f sps", s_modeName[mode], r.stopSps);
+
+      if (c == 0) def[mode] = r;
+    }
+  }
+
+  /* 기본 프로파일: 가감속 모드는 탈조 여유가 있고 등속보다 빠르며,
+   * S-curve는 토크가 가장 적은 고속 구간에서 가속도를 줄이므로 여유가 더 크다 */
+  CHECK(def[STEPPER_PROFILE_TRAPEZOID].minMargin > 0.0, "TRAP margin %.3f", def[STEPPER_PROFILE_TRAPEZOID].minMargin);
+  CHECK(def[STEPPER_PROFILE_SCURVE].minMargin > 0.0, "SCURVE margin %.3f", def[STEPPER_PROFILE_SCURVE].minMargin);
+  CHECK(def[STEPPER_PROFILE_SCURVE].minMargin > def[STEPPER_PROFILE_TRAPEZOID].minMargin, "SCURVE margin not above TRAP");
+  CHECK(def[STEPPER_PROFILE_TRAPEZOID].tripS < def[STEPPER_PROFILE_CONSTANT].tripS, "TRAP not faster than CONST");
+  CHECK(def[STEPPER_PROFILE_SCURVE].tripS < def[STEPPER_PROFILE_CONSTANT].tripS, "SCURVE not faster than CONST");
+}
+
+
+/* ==============================
+ *   2) S-curve 테이블 vs double 기준
+ * ==============================
+ * BuildSCurve와 같은 적분(스텝마다 da = J*dt, dv = a*dt, dt = 1/v)을 double로 수행하고
+ * 간격은 나눗셈 1e6/v로 바로 구한다 (Newton-Raphson 역수의 기준).
+ * 가속도 하강 시작 조건 a^2 >= 2*J*(v_cruise - v)는 펌웨어처럼 정수 sps로 잘라 비교해야
+ * 하강 시작 스텝이 같아진다 (한 스텝만 어긋나도 끝부분이 수 us 벌어짐).
+ */
+static uint16_t RefSCurve(double start, double cruise, double accel, double jerk, uint16_t *out)
+{
+  double v = start, a = 0;
+  bool down = false;
+  uint16_t n = 0;
+
+  while (n < STEPPER_RAMP_MAX && v < cruise)
+  {
+    double dt = 1.0 / v;
+    out[n++] = (uint16_t)(1e6 * dt + 0.5);
+
+    double da = jerk * dt;
+    if (!down && floor(a) * floor(a) >= 2.0 * jerk * floor(cruise - v)) down = true;
+
+    if (down) a = (a > da) ? (a - da) : 0;
+    else      a = (a + da > accel) ? accel : (a + da);
+    if (down && a == 0) break;
+
+    v += a * dt;
+  }
+  return n;
+}
+
+static void CheckSCurveTable(uint16_t start, uint16_t cruise, uint16_t accel, uint32_t jerk, bool expectFull)
+{
+  static uint16_t ref[STEPPER_RAMP_MAX];
+
+  ResetMotor();
+  Stepper_SetJerk(&s_m, jerk);
+  Stepper_SetProfile(&s_m, start, cruise, accel);
+  Stepper_SetProfileMode(&s_m, STEPPER_PROFILE_SCURVE);
+
+  uint16_t n = s_m.rampLen;
+  uint16_t nRef = RefSCurve(start, Stepper_GetDirCruise(&s_m, DIR_UP), accel, jerk, ref);
+  uint16_t cmp = (n < nRef) ? n : nRef;
+
+  int maxErr = 0;
+  uint16_t at = 0;
+  for (uint16_t i = 0; i < cmp; i++)
+  {
+    int e = abs((int)s_m.ramp[i] - (int)ref[i]);
+    if (e > maxErr) { maxErr = e; at = i; }
+  }
+
+  printf("scurve %5u->%-5u a=%-5u j=%-6u  len %3u (ref %3u)  max |err| %d us @%u (%u us)\n",
+         start, cruise, accel, (unsigned)jerk, n, nRef, maxErr, at, s_m.ramp[at]);
+
+  /* 고정소수점 테이블은 전 구간에서 기준과 1us(반올림 한 칸) 이내 */
+  CHECK(maxErr <= 1, "max error %d us at step %u", maxErr, at);
+  CHECK(abs((int)n - (int)nRef) <= 1, "length %u vs ref %u", n, nRef);
+  if (expectFull) CHECK(n == STEPPER_RAMP_MAX, "table not full: %u", n);
+}
+
+
+int main(void)
+{
+  BenchProfiles();
+
+  printf("\n");
+  CheckSCurveTable(STEPPER_START_SPS_DEFAULT, STEPPER_CRUISE_SPS_DEFAULT, STEPPER_ACCEL_DEFAULT, STEPPER_JERK_DEFAULT, false);
+  CheckSCurveTable(STEPPER_START_SPS_DEFAULT, 1400, STEPPER_ACCEL_DEFAULT, STEPPER_JERK_DEFAULT, false);
+  CheckSCurveTable(100, 5000, 1500, 6000, true);           // 테이블 끝(STEPPER_RAMP_MAX)까지
+  CheckSCurveTable(STEPPER_START_SPS_MIN, 5000, 400, 800, true);
+  CheckSCurveTable(400, 5000, 20000, 1000000, false);      // 큰 저크: 저속에서 c 반감 경로
+
+  return HOST_TEST_RESULT();
+}